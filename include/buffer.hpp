@@ -14,9 +14,14 @@
 
 #include <pthread.h>
 #include <stdint.h>
+#include <atomic>
 #include "implot/implot.h"
 
-#define MAX_ROLLBUF_LEN 500
+#define MAX_ROLLBUF_LEN 600   // Rows of ACS history.
+#define ACS_GAP_HISTORY 16    // Most recent gaps kept for display.
+#define ACS_DECODE_BLOCK 64   // Packets gathered per conversion pass in acs_upd_decode(...).
+#define TELEM_TIERS 3         // Downsampled tiers behind the full-rate ring.
+#define TELEM_TIER_LEN 360    // Buckets per tier: an hour of 10 s, six of 1 min, sixty of 10 min.
 
 /**
  * @brief The ACS update data format sent from SPACE-HAUC to Ground.
@@ -32,47 +37,201 @@
  *      memcpy(output->data, &acs_upd, output->data_size);
  *  }
  * 
+ * bx through sz are IEEE half-precision floats (__fp16 on board). Not every host compiler has a half type, so they are kept here as their raw bit patterns; acs_upd_decode(...) turns them into floats.
+ * 
  * @return typedef struct 
  */
-#ifndef __fp16
-#define __fp16 uint16_t
-#endif // __fp16
 typedef struct __attribute__((packed))
 {
     uint8_t ct;      // Set in acs.c.
     uint8_t mode;    // Set in acs.c.
-    __fp16 bx;       // Set in acs.c.
-    __fp16 by;       // Set in acs.c.
-    __fp16 bz;       // Set in acs.c.
-    __fp16 wx;       // Set in acs.c.
-    __fp16 wy;       // Set in acs.c.
-    __fp16 wz;       // Set in acs.c.
-    __fp16 sx;       // Set in acs.c.
-    __fp16 sy;       // Set in acs.c.
-    __fp16 sz;       // Set in acs.c.
+    uint16_t bx;     // Set in acs.c. Half-precision.
+    uint16_t by;     // Set in acs.c. Half-precision.
+    uint16_t bz;     // Set in acs.c. Half-precision.
+    uint16_t wx;     // Set in acs.c. Half-precision.
+    uint16_t wy;     // Set in acs.c. Half-precision.
+    uint16_t wz;     // Set in acs.c. Half-precision.
+    uint16_t sx;     // Set in acs.c. Half-precision.
+    uint16_t sy;     // Set in acs.c. Half-precision.
+    uint16_t sz;     // Set in acs.c. Half-precision.
     uint16_t vbatt;  // Set in cmd_parser.
     uint16_t vboost; // Set in cmd_parser.
     uint16_t cursun; // Set in cmd_parser.
     uint16_t cursys; // Set in cmd_parser.
 } acs_upd_output_t;
 
-// From https://github.com/SPACE-HAUC/mtq_tester/blob/master/guimain.cpp
-class ScrollBuf
+// Channels of an ACS update, in acs_upd_output_t order.
+enum ACS_CH
+{
+    ACS_CH_CT = 0,
+    ACS_CH_MODE,
+    ACS_CH_BX,
+    ACS_CH_BY,
+    ACS_CH_BZ,
+    ACS_CH_WX,
+    ACS_CH_WY,
+    ACS_CH_WZ,
+    ACS_CH_SX,
+    ACS_CH_SY,
+    ACS_CH_SZ,
+    ACS_CH_VBATT,
+    ACS_CH_VBOOST,
+    ACS_CH_CURSUN,
+    ACS_CH_CURSYS,
+    ACS_CH_NUM
+};
+
+/**
+ * @brief Decodes ACS updates into one float column per channel, converting the half-precision fields in bulk.
+ * 
+ * @param pkts Updates as received.
+ * @param n Number of updates.
+ * @param cols ACS_CH_NUM columns of at least n floats each.
+ */
+void acs_upd_decode(const acs_upd_output_t *pkts, int n, float *const *cols);
+
+/**
+ * @brief One downsampled level of a TelemetryStore: fixed-length UTC-aligned buckets, each summarizing every row received within it.
+ * 
+ */
+typedef struct
+{
+    uint64_t interval; // Nanoseconds per bucket.
+    int head;          // Next bucket to open; the oldest once full.
+    int count;         // Buckets held.
+    uint64_t cur;      // t_utc / interval of the open bucket.
+    uint64_t *t_utc;   // Bucket start.
+    // num_ch columns of TELEM_TIER_LEN values, back to back. Buckets a channel had no values in hold NaN.
+    float *min;
+    float *max;
+    float *mean;
+    int *n; // Values averaged.
+} telem_tier_t;
+
+/**
+ * @brief Column-oriented rolling history of a fixed set of channels sampled together.
+ * 
+ * Two timestamp columns and one contiguous float column per channel, all sharing a single head, so every channel holds the same rows and a row's time is stored once rather than once per channel. Times are int64 nanoseconds taken when the row's data reached the socket: CLOCK_MONOTONIC for intervals, CLOCK_REALTIME (UTC) for plotting and for lining telemetry up with anything else on a wall clock. Columns are in ring order starting at offset(); plots read them in place through a getter indexed by slot.
+ * 
+ * Each channel's minimum and maximum are kept in monotonic deques updated as rows are pushed, so min() and max() cost the same however much history is held: amortized O(1) per push, O(1) per query.
+ * 
+ * Behind the full-rate ring, each row is also folded into TELEM_TIERS downsampled tiers of 10 s, 1 min and 10 min buckets holding every channel's minimum, maximum and mean, so long spans can be drawn from a bounded number of points. A bucket is updated in place as its rows arrive; a row past the end of the open bucket opens the next one, preceded by a NaN bucket if whole intervals went by empty so the plots break there as well. A row stamped before the open bucket, as after a step back of the wall clock, is folded into the open bucket.
+ * 
+ * Replaces the per-channel ScrollBuf from https://github.com/SPACE-HAUC/mtq_tester/blob/master/guimain.cpp.
+ * 
+ */
+class TelemetryStore
 {
 public:
-    ScrollBuf();
-    ScrollBuf(int max_size);
+    TelemetryStore(int num_channels, int capacity);
+    ~TelemetryStore();
 
-    void AddPoint(float x, float y);
-    void Erase();
-    float Max();
-    float Min();
+    /**
+     * @brief Appends one row, overwriting the oldest once full.
+     * 
+     * @param t_mono lat_now_ns() when the row was received.
+     * @param t_utc CLOCK_REALTIME nanoseconds at the same moment.
+     * @param values One value per channel.
+     */
+    void push(uint64_t t_mono, uint64_t t_utc, const float *values);
 
-    int max_sz;
-    int ofst;
-    ImVector<ImVec2> data;
+    /**
+     * @brief Appends a row of NaN; plotted lines are broken across it.
+     * 
+     */
+    void pushBreak(uint64_t t_mono, uint64_t t_utc);
+
+    void clear();
+
+    int size();     // Rows held.
+    int offset();   // Index of the oldest row.
+    int capacity();
+    int channels();
+
+    const uint64_t *monoTimes();
+    const uint64_t *utcTimes();
+    const float *column(int ch);
+
+    double seconds(int slot); // UTC seconds, as plotted.
+
+    // Over the rows held from the last range(...) start on, skipping breaks; zero if there are none.
+    float min(int ch);
+    float max(int ch);
+
+    /**
+     * @brief Lowest and highest value of a channel over the rows in [start, end], skipping breaks; zero for both if there are none.
+     * 
+     * Taken from min(...) and max(...) after retiring rows older than start from the deques, which is O(1) amortized while start only moves forward, as it does for a span ending now. A start earlier than the last rebuilds the deques once; rows newer than end, which only a wall clock step back leaves, fall back to scanning the rows held.
+     * 
+     */
+    void range(int ch, double start, double end, float *lo, float *hi);
+
+    /**
+     * @brief The coarsest resolution needed to draw a span: -1 for the full-rate rows if they reach back to start, otherwise the finest tier whose buckets for the span fit in the tier.
+     * 
+     * @param start UTC seconds at the left edge.
+     * @param end UTC seconds at the right edge.
+     */
+    int pickTier(double start, double end);
+
+    const telem_tier_t *tier(int idx);
+    double tierSeconds(int idx, int slot); // UTC seconds at the middle of a bucket, as plotted.
+
+    /**
+     * @brief Lowest minimum and highest maximum of a channel over the buckets of a tier that overlap [start, end]; zero for both if there are none.
+     * 
+     */
+    void tierRange(int idx, int ch, double start, double end, float *lo, float *hi);
+
+private:
+    void fold(telem_tier_t *tr, uint64_t utc, const float *values);
+    void open(telem_tier_t *tr, uint64_t bucket, const float *values);
+
+    void advance();
+    void extend(int dq, int slot, float value, bool want_max);
+    float front(int dq);
+    void window(double start);
+
+    int num_ch;
+    int cap;
+    int count;
+    int head; // Next row to write; the oldest once full.
+    uint64_t *t_mono;
+    uint64_t *t_utc;
+    float *cols; // num_ch columns of cap values, back to back.
+
+    // Two deques per channel (minimum at 2 * ch, maximum at 2 * ch + 1) of row slots, oldest first, whose values are increasing and decreasing respectively; each a ring of cap entries.
+    int *dq_slots;
+    int *dq_head;
+    int *dq_len;
+    double dq_start; // UTC seconds; rows older than this have been retired from the deques.
+
+    telem_tier_t tiers[TELEM_TIERS];
 };
 
+/**
+ * @brief A run of ACS samples that never arrived.
+ * 
+ */
+typedef struct
+{
+    uint64_t t_utc;  // Receipt of the first sample after the gap.
+    double span;     // Seconds between the samples either side.
+    uint8_t ct_from; // Last ct before the gap.
+    uint8_t ct_to;   // First ct after it.
+    int missing;     // Samples lost; zero for a restart of the counter.
+} acs_gap_t;
+
+/**
+ * @brief Rolling plot history of ACS updates.
+ * 
+ * Samples are placed on the time axis by when they were received, and checked for continuity by their ct counter, which SPACE-HAUC advances by one per update and which wraps at 256. A jump in ct is a gap: the samples in between were lost, and a break is inserted so the plots do not draw a line across the missing span. A ct that repeats is a duplicate and is dropped; one that goes backwards by more than half the counter range is taken as a restart of the counter rather than 200-odd lost samples.
+ * 
+ * A gap longer than 255 samples aliases onto a shorter one; ct alone cannot tell them apart.
+ * 
+ * Confined to the GUI thread, which needs no lock or snapshot to see every channel in step: the RX thread hands updates over through RxMsgQueue and gs_rx_drain(...) adds them between frames, so no row is ever half-written while the plots read. The thread that constructs the buffer owns it, so construct it on the GUI thread; addValueSet(...) from any other thread is refused and counted in foreign_writes.
+ * 
+ */
 class ACSRollingBuffer
 {
 public:
@@ -84,20 +243,41 @@ public:
      * @brief Adds a value set to the rolling buffer.
      * 
      * @param data The data to be copied into the buffer.
+     * @param t_mono lat_now_ns() when the update reached the socket.
+     * @param t_utc CLOCK_REALTIME nanoseconds at the same moment.
+     */
+    void addValueSet(acs_upd_output_t data, uint64_t t_mono, uint64_t t_utc);
+
+    /**
+     * @brief Clears the loss statistics and gap history; the plotted history is kept.
+     * 
      */
-    void addValueSet(acs_upd_output_t data);
+    void resetStats();
+
+    int gapCount();
+    const acs_gap_t *gap(int idx); // Zero is the most recent.
+
+    TelemetryStore store; // ACS_CH columns.
 
-    // Separated by the graphs they'll appear in.
-    ScrollBuf ct, mode;
-    ScrollBuf bx, by, bz;
-    ScrollBuf wx, wy, wz;
-    ScrollBuf sx, sy, sz;
-    ScrollBuf vbatt, vboost;
-    ScrollBuf cursun, cursys;
+    // Per-session sequence statistics.
+    uint64_t samples;    // Samples plotted.
+    uint64_t missing;    // Samples known lost, from jumps in ct.
+    uint64_t gaps;       // Jumps in ct.
+    uint64_t duplicates; // Repeated ct values, dropped.
+    uint64_t restarts;   // ct went backwards.
+    int longest_gap;     // Most samples lost in one gap.
 
-    float x_index;
+    std::atomic<uint64_t> foreign_writes; // Value sets refused for coming from a thread other than the owner.
 
-    pthread_mutex_t acs_upd_inhibitor;
+private:
+    pthread_t owner;
+    bool have_ct;
+    uint8_t last_ct;
+    uint64_t last_mono;
+    uint64_t last_utc;
+    acs_gap_t gap_history[ACS_GAP_HISTORY];
+    int gap_head; // Next slot to write.
+    int num_gaps;
 };
 
 #endif // BUFFER_HPP
\ No newline at end of file
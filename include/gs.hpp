@@ -20,9 +20,23 @@
 #include "implot/implot.h"
 #include "network.hpp"
 #include "buffer.hpp"
+#include "gs_rx.hpp"
+#include "spsc.hpp"
+#include "gs_latency.hpp"
+#include "gs_tx.hpp"
+#include "gs_cmd.hpp"
+#include "gs_sched.hpp"
 
 #define SEC *1000000
 #define ACS_UPDATE_FREQUENCY 0.5 // seconds
+#define ACS_POLL_PERIOD_MIN 500  // Milliseconds; any faster than 0.5 seconds seems to break the Network.
+#define ACS_POLL_PERIOD_SLOW 5000 // Milliseconds; the adaptive poller never goes slower than 0.2 Hz, nor faster than ACS_POLL_PERIOD_MIN.
+#define ACS_POLL_TIMEOUT 2000     // Milliseconds after which an unanswered request counts as lost.
+#define ACS_POLL_OUTSTANDING 64   // Unanswered requests remembered; older ones count as lost.
+#define ACS_LOSS_WINDOW 20        // Request outcomes per loss estimate.
+#define ACS_LOSS_HIGH 0.10        // Back off above this loss fraction...
+#define ACS_LOSS_LOW 0.02         // ...and speed up at or below this one.
+#define ACS_RATE_STEP 0.5         // Hz added after each window at low loss.
 #define MAX_DATA_SIZE 46
 #define ACS_UPD_DATARATE 100
 #define RECV_TIMEOUT 15    // seconds
@@ -61,6 +75,21 @@ enum MODULE_ID
     SYS_CLEAN_SHBYTES = 0xfd
 };
 
+/**
+ * @brief Uplink class for a command: restarts, reboots, and cleanups jump ahead of everything else queued.
+ * 
+ * @param mod MODULE_ID
+ * @return int TX_CLASS, or -1 for the sender's default class.
+ */
+static inline int gs_cmd_tx_class(int mod)
+{
+    if (mod == SYS_RESTART_PROG || mod == SYS_REBOOT || mod == SYS_CLEAN_SHBYTES)
+    {
+        return TX_CLASS_SAFETY;
+    }
+    return -1;
+}
+
 /**
  * @brief Function magic for software update command, replaces .cmd value.
  * 
@@ -420,6 +449,214 @@ typedef struct
     bool tooltips;
 } settings_t;
 
+#define RX_QUEUE_LEN 256 // Decoded messages buffered between the RX and GUI threads.
+
+enum RX_MSG_KIND
+{
+    RX_MSG_ACK = 0,
+    RX_MSG_NACK,
+    RX_MSG_XBAND_CONFIG,
+    RX_MSG_CMD_OUTPUT,
+    RX_MSG_ACS_UPD,
+};
+
+/**
+ * @brief A decoded message handed from the RX thread to the GUI thread.
+ * 
+ */
+typedef struct
+{
+    int kind;           // RX_MSG_KIND
+    uint64_t t_ready;   // Socket became readable (lat_now_ns()).
+    uint64_t t_handled; // Handler posted the message (lat_now_ns()).
+    uint64_t t_utc;     // CLOCK_REALTIME nanoseconds as of t_ready.
+    union
+    {
+        cs_ack_t ack;
+        xband_set_data_t xband_config;
+        cmd_output_t cmd_output;
+        acs_upd_output_t acs_upd;
+    };
+} rx_msg_t;
+
+// Message classes; each has its own bounded ring and overload policy.
+enum RX_MSG_CLASS
+{
+    RX_CLASS_CONTROL = 0, // ACK/NACK, configurations, command output.
+    RX_CLASS_TELEMETRY,   // ACS updates.
+    RX_CLASS_NUM
+};
+
+// What the RX thread does when a class's ring is full.
+enum RX_QUEUE_POLICY
+{
+    RX_POLICY_DROP_OLDEST = 0, // Discard the oldest queued message; stale telemetry is worthless.
+    RX_POLICY_DROP_NEWEST,     // Discard the incoming message.
+    RX_POLICY_BLOCK,           // Never drop: back off until the GUI makes room, stalling the RX thread (and so the TCP window).
+};
+
+#define RX_BLOCK_BACKOFF_MIN 50   // First back-off sleep when blocked, microseconds.
+#define RX_BLOCK_BACKOFF_MAX 5000 // Back-off sleep ceiling, microseconds.
+
+/**
+ * @brief Bounded, lock-free handoff of decoded messages from the RX thread (producer) to the GUI thread (consumer), with a per-class overload policy.
+ * 
+ */
+class RxMsgQueue
+{
+public:
+    RxMsgQueue();
+
+    /**
+     * @brief RX thread. Queues a message according to its class's policy.
+     * 
+     * @param msg The message.
+     * @return int 1 if queued, 0 if queued by evicting an older message, -1 if the message was dropped.
+     */
+    int push(const rx_msg_t *msg);
+
+    /**
+     * @brief Releases a producer blocked in push(...) and makes further blocking pushes drop instead. Called at shutdown, once the GUI stops draining.
+     * 
+     */
+    void close();
+
+    /**
+     * @brief GUI thread. Dequeues the next message, control messages first.
+     * 
+     * @return true if a message was dequeued.
+     */
+    bool pop(rx_msg_t *msg);
+
+    size_t size(int cls);
+    size_t capacity();
+
+    static int classify(int kind);
+    static const char *class_name(int cls);
+    static const char *policy_name(int policy);
+
+    std::atomic<int> policy[RX_CLASS_NUM];
+    std::atomic<uint64_t> queued[RX_CLASS_NUM];
+    std::atomic<uint64_t> dropped[RX_CLASS_NUM];    // Messages discarded, either oldest or newest.
+    std::atomic<uint64_t> blocked[RX_CLASS_NUM];    // Times the RX thread had to wait for room.
+    std::atomic<uint64_t> high_water[RX_CLASS_NUM]; // Deepest the ring has been.
+
+private:
+    SPSCEvictRing<rx_msg_t, RX_QUEUE_LEN> ring[RX_CLASS_NUM];
+    std::atomic<bool> closed;
+};
+
+/**
+ * @brief Polls SPACE-HAUC for ACS updates from one long-lived thread.
+ * 
+ * While active, the poller thread sends a request at every multiple of the period after start(), sleeping on an absolute CLOCK_MONOTONIC deadline so the cadence neither drifts nor depends on the GUI frame rate. Deadlines missed entirely (e.g. the thread was descheduled) are skipped, not made up in a burst.
+ * 
+ * In adaptive mode the poller also picks the period. Updates carry no sequence number, so each one received answers the oldest outstanding request, and requests unanswered after ACS_POLL_TIMEOUT are lost. Once ACS_LOSS_WINDOW requests sent at the current rate have been answered or lost, the rate rises by ACS_RATE_STEP toward 2 Hz (ACS_POLL_PERIOD_MIN) if loss stayed at or below ACS_LOSS_LOW, or halves if it went above ACS_LOSS_HIGH.
+ * 
+ */
+class AcsPoller
+{
+public:
+    AcsPoller(TxEngine *tx);
+    ~AcsPoller();
+
+    /**
+     * @brief Starts periodic polling.
+     * 
+     * @return int 1 on success, negative on failure.
+     */
+    int start();
+
+    /**
+     * @brief Stops periodic polling and joins the poller thread.
+     * 
+     */
+    void stop();
+
+    bool active();
+
+    /**
+     * @brief Any thread. Sends one update request now, unless periodic polling is active or one went out less than ACS_POLL_PERIOD_MIN ago.
+     * 
+     * @return int The TX tag on success, 0 if refused, negative if the TX queue was full.
+     */
+    int poll_once();
+
+    /**
+     * @brief Any thread. Changes the period, clamped to at least ACS_POLL_PERIOD_MIN; takes effect from the next deadline. Turns adaptive mode off.
+     * 
+     */
+    void set_period(int ms);
+
+    /**
+     * @brief The period periodic requests go out at. Neither set_period(...) nor the loss controller goes below ACS_POLL_PERIOD_MIN, the spacing send(...) enforces between any two requests, so no periodic request is refused for being too soon and this is the rate actually sent.
+     * 
+     */
+    int period();
+
+    /**
+     * @brief Any thread. Lets the loss controller choose the period, starting from the current one.
+     * 
+     */
+    void set_adaptive(bool on);
+    bool adaptive();
+
+    /**
+     * @brief Any thread; called by the RX thread for every ACS update received.
+     * 
+     */
+    void received();
+
+    /**
+     * @brief Fraction of requests lost over the last ACS_LOSS_WINDOW outcomes.
+     * 
+     */
+    double loss();
+
+    /**
+     * @brief Poller thread body.
+     * 
+     */
+    void run();
+
+    std::atomic<uint64_t> polls;
+    std::atomic<uint64_t> too_soon; // One-shot requests refused for coming too soon after the last.
+    std::atomic<uint64_t> overruns; // Deadlines skipped because the poller woke up after the next one.
+    LatencyHistogram late;          // How far past each deadline the request went out.
+    std::atomic<uint64_t> answered; // Requests matched to an update.
+    std::atomic<uint64_t> lost;     // Requests that went unanswered.
+    std::atomic<uint64_t> backoffs; // Times the controller halved the rate.
+
+private:
+    int send(uint64_t at); // Refuses, counting too_soon, unless at is ACS_POLL_PERIOD_MIN past the last request.
+    void account(uint64_t now);
+    void outcome(bool ok, uint64_t t_sent);
+    void adapt(uint64_t now);
+
+    // Poller thread only.
+    uint64_t outstanding[ACS_POLL_OUTSTANDING]; // lat_now_ns() of unanswered requests, oldest first from out_head.
+    int out_head;
+    int out_count;
+    uint64_t responses_seen;
+    bool window[ACS_LOSS_WINDOW]; // Recent outcomes at the current rate; true if answered.
+    int win_head;
+    int win_count;
+    uint64_t t_adjust; // lat_now_ns() of the last rate change; earlier requests say nothing about the current rate.
+
+    TxEngine *tx;
+    std::atomic<int> period_ms;
+    std::atomic<bool> adaptive_on;
+    std::atomic<uint64_t> responses; // ACS updates received, from the RX thread.
+    std::atomic<int> win_lost;       // Lost outcomes in window.
+    std::atomic<int> win_total;      // Outcomes in window.
+    std::atomic<uint64_t> t_last; // lat_now_ns() the last request was sent at; claimed by compare-exchange in send(...).
+    std::atomic<bool> running;
+    bool thread_started;
+    pthread_t thread;
+    int timerfd;
+    int wakefd;
+};
+
 /**
  * @brief Contains structures and classes that will be populated with data by the receive thread; these structures and classes also provide the data which the client will display.
  * 
@@ -429,13 +666,22 @@ typedef struct
     // Data
     NetDataClient *network_data;
     ACSRollingBuffer *acs_rolbuf;
+    RxFramePool *rx_pool;
+    RxStream *rx_stream;
+    RxEngine *rx_engine;
+    RxDispatcher *rx_dispatcher;
+    RxLatency *rx_latency;
+    TxEngine *tx_engine;
+    RxMsgQueue *rx_queue;
+    CmdTracker *cmd_tracker;
+    CmdScheduler *cmd_sched;
+    AcsPoller *acs_poller;
 
     settings_t settings[1];
     cs_ack_t cs_ack[1];
     cs_config_uhf_t cs_config_uhf[1];
     // TODO: Delete cs_config_xband because we will be using phy_config_t (see below) instead.
     xband_set_data_t cs_config_xband[1];
-    cmd_output_t cmd_output[1];
 
     uint8_t netstat;
     double last_contact;
@@ -538,13 +784,6 @@ void *gs_check_password(void *arg);
  */
 int gs_helper(void *aa);
 
-/**
- * @brief Handles the asynchronous sending of the ACS update data retrieval command.
- * 
- * @param vp Pointer to the acs_upd_input_t structure.
- * @return void* Pointer to the original argument.
- */
-void *gs_acs_update_thread(void *vp);
 
 // /**
 //  * @brief Transmits data to SPACE-HAUC.
@@ -562,6 +801,23 @@ void *gs_acs_update_thread(void *vp);
 //  */
 // void *gs_polling_thread(void *args);
 
+/**
+ * @brief Registers the client's built-in frame handlers with global->rx_dispatcher.
+ * 
+ * Must be called before the RX thread is started.
+ * 
+ * @param global The global data.
+ */
+void gs_rx_register_handlers(global_data_t *global);
+
+/**
+ * @brief Applies every message the RX thread has queued to the global data. Called once per frame by the GUI thread.
+ * 
+ * @param global The global data.
+ * @return int Number of messages applied.
+ */
+int gs_rx_drain(global_data_t *global);
+
 /**
  * @brief 
  * 
@@ -570,6 +826,22 @@ void *gs_acs_update_thread(void *vp);
  */
 void *gs_rx_thread(void *args);
 
+/**
+ * @brief Sends every frame submitted to global->tx_engine, in order, and reports each outcome. The only thread that writes to the server socket.
+ * 
+ * @param args global_data_t
+ * @return void* 
+ */
+void *gs_tx_thread(void *args);
+
+/**
+ * @brief Keeps the server connection alive with a POLL every SERVER_POLL_RATE seconds while connected. Replaces the network library's gs_polling_thread(...), which wrote to the socket itself; these go through global->tx_engine like every other frame.
+ * 
+ * @param args global_data_t
+ * @return void* 
+ */
+void *gs_keepalive_thread(void *args);
+
 /**
  * @brief 
  * 
@@ -0,0 +1,183 @@
+/**
+ * @file gs_cmd.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Correlates commands sent to SPACE-HAUC with their replies.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef GS_CMD_HPP
+#define GS_CMD_HPP
+
+#include <stdint.h>
+#include "gs_latency.hpp"
+
+#define CMD_INFLIGHT_MAX 64        // Commands awaiting a reply.
+#define CMD_HISTORY_LEN 32         // Completed requests kept for display.
+#define CMD_STATS_MAX 64           // Distinct (module, command) pairs with round-trip statistics.
+#define CMD_TIMEOUT_DEFAULT 30000  // Milliseconds to wait for a reply unless the module says otherwise.
+#define CMD_DATA_LEN 46            // Matches cmd_output_t::data.
+#define CMD_UNSENT_LEN 32          // TX tags that failed before their request was tracked.
+
+// How a tracked request ended.
+enum CMD_STATUS
+{
+    CMD_STATUS_PENDING = 0,
+    CMD_STATUS_ANSWERED,  // Matched to a reply.
+    CMD_STATUS_TIMED_OUT, // No reply before its deadline.
+    CMD_STATUS_UNMATCHED, // A reply with no pending request, e.g. one that arrived after its request timed out.
+    CMD_STATUS_NOT_SENT,  // The TX thread could not send it; no reply will come.
+};
+
+/**
+ * @brief A command awaiting its reply.
+ *
+ */
+typedef struct
+{
+    bool used;
+    uint32_t seq;      // Local sequence number; increases with every tracked command.
+    int mod;
+    int cmd;
+    int origin;        // TX_ORIGIN
+    int tx_tag;        // TxEngine::submit(...) tag.
+    uint64_t t_sent;   // lat_now_ns() at submission.
+    uint64_t deadline; // lat_now_ns() after which the request times out.
+} cmd_pending_t;
+
+/**
+ * @brief A finished request.
+ *
+ */
+typedef struct
+{
+    uint32_t seq; // Zero for unmatched replies.
+    int mod;
+    int cmd;
+    int status; // CMD_STATUS
+    int retval;
+    int data_size;
+    uint64_t rtt; // Nanoseconds; zero unless answered.
+    unsigned char data[CMD_DATA_LEN];
+} cmd_done_t;
+
+/**
+ * @brief Reply counts and round-trip distribution for one (module, command) pair.
+ *
+ */
+typedef struct
+{
+    int mod;
+    int cmd;
+    uint64_t sent;
+    uint64_t answered;
+    uint64_t timed_out;
+    uint64_t unmatched;
+    uint64_t not_sent;
+    LatencyHistogram *rtt;
+} cmd_stats_t;
+
+/**
+ * @brief In-flight table of commands sent to SPACE-HAUC, keyed by (module, command) and a local sequence number.
+ *
+ * Replies do not carry the sequence number, so each reply is matched to the oldest pending request with the same module and command; SPACE-HAUC answers commands in the order it receives them.
+ *
+ * Used only by the GUI thread: commands are tracked when submitted, replies are matched as gs_rx_drain(...) collects them, frames the TX thread could not send are finished by TxEngine::drain_events(...), and timeouts are enforced by expire(...) once per frame.
+ *
+ */
+class CmdTracker
+{
+public:
+    CmdTracker();
+    ~CmdTracker();
+
+    /**
+     * @brief Starts tracking a submitted command.
+     *
+     * @param mod Module ID.
+     * @param cmd Command ID.
+     * @param origin TX_ORIGIN it was submitted from.
+     * @param tx_tag Tag returned by TxEngine::submit(...).
+     * @param timeout_ms Milliseconds to wait for the reply; zero for the module's timeout.
+     * @param t_sent lat_now_ns() at submission, if it was not just now.
+     * @return uint32_t The request's sequence number, or zero if the in-flight table is full.
+     */
+    uint32_t track(int mod, int cmd, int origin, int tx_tag, int timeout_ms = 0, uint64_t t_sent = 0);
+
+    /**
+     * @brief Matches a reply to the oldest pending request with the same module and command.
+     *
+     * @param t_recv lat_now_ns() when the reply reached the socket.
+     * @return uint32_t The matched sequence number, or zero if nothing was pending.
+     */
+    uint32_t reply(int mod, int cmd, int retval, const unsigned char *data, int data_size, uint64_t t_recv);
+
+    /**
+     * @brief Finishes the request submitted under a TX tag as CMD_STATUS_NOT_SENT, rather than leaving it to time out.
+     *
+     * A scheduled command is tracked a frame after its submission, so a tag that matches nothing yet is remembered and finishes its request as soon as it is tracked.
+     *
+     */
+    void unsent(int tx_tag);
+
+    /**
+     * @brief Times out every request whose deadline has passed.
+     *
+     * @return int Number of requests timed out.
+     */
+    int expire(uint64_t now);
+
+    /**
+     * @brief Sets how long commands to a module wait for their reply.
+     *
+     */
+    void set_timeout(int mod, int timeout_ms);
+    int timeout(int mod);
+
+    int pending_count();
+    const cmd_pending_t *pending(int idx); // Any order; NULL for unused slots.
+
+    /**
+     * @brief Looks up a request by sequence number.
+     *
+     * @param out Set to the completed request, if it is still in the history.
+     * @return int CMD_STATUS_PENDING if still in flight, the completed status if found, negative if no longer known.
+     */
+    int lookup(uint32_t seq, cmd_done_t *out);
+
+    int history_count();
+    const cmd_done_t *history(int idx); // Zero is the most recent.
+
+    int stats_count();
+    const cmd_stats_t *stats(int idx);
+
+    void reset_stats();
+
+    static const char *status_name(int status);
+
+private:
+    cmd_stats_t *find_stats(int mod, int cmd);
+    void finish(int mod, int cmd, uint32_t seq, int status, int retval, const unsigned char *data, int data_size, uint64_t rtt);
+
+    cmd_pending_t inflight[CMD_INFLIGHT_MAX];
+    int num_inflight;
+    uint32_t next_seq;
+
+    cmd_done_t done[CMD_HISTORY_LEN];
+    int done_head; // Next slot to write.
+    int num_done;
+
+    cmd_stats_t table[CMD_STATS_MAX];
+    int num_stats;
+
+    int timeouts[256]; // Milliseconds, per module ID.
+
+    int unsent_tags[CMD_UNSENT_LEN]; // Ring of tags passed to unsent(...) before their request was tracked; zero when empty.
+    int unsent_head;
+};
+
+#endif // GS_CMD_HPP
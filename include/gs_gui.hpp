@@ -15,14 +15,34 @@
 #ifndef GS_GUI_HPP
 #define GS_GUI_HPP
 
+/**
+ * @brief Displays the outcome of the most recent transmission from an origin.
+ * 
+ * @param global 
+ * @param origin TX_ORIGIN
+ */
+void gs_gui_tx_status(global_data_t *global, int origin);
+
+/**
+ * @brief Sends a command to SPACE-HAUC over the roof UHF and tracks it until its reply arrives or it times out.
+ * 
+ * @param global 
+ * @param command_input The command.
+ * @param origin TX_ORIGIN of the window sending it.
+ * @return uint32_t The command's tracking sequence number, or zero if it could not be queued or tracked.
+ */
+uint32_t gs_gui_cmd_send(global_data_t *global, const cmd_input_t *command_input, int origin);
+
 /**
  * @brief Handles the 'Transmit' section of panels, including display of queued data and the send button.
  * 
+ * @param global 
+ * @param origin TX_ORIGIN of the calling panel.
  * @param auth Current authentication object.
  * @param command_input The command to be augmented.
  * @return int Positive on success, negative on failure.
  */
-int gs_gui_gs2sh_tx_handler(NetDataClient *network_data, int access_level, cmd_input_t *command_input, bool allow_transmission);
+int gs_gui_gs2sh_tx_handler(global_data_t *global, int origin, int access_level, cmd_input_t *command_input, bool allow_transmission);
 
 /**
  * @brief 
@@ -58,7 +78,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
  * @param auth 
  * @param allow_transmission 
  */
-void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access_level, bool allow_transmission);
+void gs_gui_eps_window(global_data_t *global, bool *EPS_window, int access_level, bool allow_transmission);
 
 /**
  * @brief 
@@ -88,7 +108,7 @@ void gs_gui_sw_upd_window(global_data_t *global, bool *SW_UPD_window, int access
  * @param auth 
  * @param allow_transmission 
  */
-void gs_gui_sys_ctrl_window(NetDataClient *network_data, bool *SYS_CTRL_window, int access_level, bool allow_transmission);
+void gs_gui_sys_ctrl_window(global_data_t *global, bool *SYS_CTRL_window, int access_level, bool allow_transmission);
 
 /**
  * @brief 
@@ -149,4 +169,22 @@ void gs_gui_disp_control_panel_window(bool *DISP_control_panel, bool *ACS_window
  */
 void gs_gui_user_manual_window(bool *User_Manual);
 
+/**
+ * @brief Displays receive-path latency percentiles, with reset and dump-to-file controls.
+ * 
+ * @param DIAG_window 
+ * @param global 
+ */
+void gs_gui_diagnostics_window(bool *DIAG_window, global_data_t *global);
+
+/**
+ * @brief Loads, arms, and monitors a schedule of time-tagged commands.
+ * 
+ * @param SCHED_window 
+ * @param access_level 
+ * @param allow_transmission 
+ * @param global 
+ */
+void gs_gui_sched_window(bool *SCHED_window, int access_level, bool allow_transmission, global_data_t *global);
+
 #endif // GS_GUI_HPP
\ No newline at end of file
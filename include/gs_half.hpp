@@ -0,0 +1,78 @@
+/**
+ * @file gs_half.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief IEEE 754 half-precision to single-precision conversion.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.30
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef GS_HALF_HPP
+#define GS_HALF_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Converts one half-precision value, given as its bit pattern, to a float. Exact for every input, including subnormals, infinities and NaN.
+ *
+ */
+static inline float half_to_float(uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    uint32_t bits;
+
+    if (exp == 0x1f)
+    {
+        // Infinity or NaN; the payload carries over.
+        bits = sign | 0x7f800000 | (mant << 13);
+    }
+    else if (exp != 0)
+    {
+        // Rebias from 15 to 127.
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+    else if (mant == 0)
+    {
+        bits = sign;
+    }
+    else
+    {
+        // Subnormal half; normal as a float.
+        exp = 113;
+        while (!(mant & 0x400))
+        {
+            mant <<= 1;
+            exp--;
+        }
+        bits = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+    }
+
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/**
+ * @brief Converts an array of half-precision bit patterns to floats.
+ *
+ * Uses the F16C conversion instructions, eight values at a time, when the CPU has them, and half_to_float(...) otherwise. The choice is made once, at the first call.
+ *
+ * @param in Half-precision bit patterns.
+ * @param out n floats.
+ * @param n Number of values.
+ */
+void half_to_float_n(const uint16_t *in, float *out, int n);
+
+/**
+ * @brief Name of the conversion half_to_float_n(...) uses on this machine, for diagnostics.
+ *
+ */
+const char *half_impl_name();
+
+#endif // GS_HALF_HPP
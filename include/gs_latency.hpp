@@ -0,0 +1,154 @@
+/**
+ * @file gs_latency.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Latency histograms for the receive path.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.26
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef GS_LATENCY_HPP
+#define GS_LATENCY_HPP
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+
+#define LAT_SUB_BITS 5                            // 32 sub-buckets per power of two; values are resolved to within ~3%.
+#define LAT_SUB_COUNT (1 << LAT_SUB_BITS)
+#define LAT_MAX_BITS 40                           // Values at or above 2^40 ns (~18 minutes) land in the last bucket.
+#define LAT_BUCKETS ((LAT_MAX_BITS - LAT_SUB_BITS + 1) * LAT_SUB_COUNT)
+#define LAT_PENDING_MAX 512                       // Messages awaiting their first render.
+
+/**
+ * @brief CLOCK_MONOTONIC in nanoseconds.
+ *
+ */
+static inline uint64_t lat_now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief CLOCK_REALTIME (UTC) in nanoseconds.
+ *
+ */
+static inline uint64_t lat_utc_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Log-linear (HDR-style) histogram of nanosecond durations.
+ *
+ * One thread records; any thread may read. Recording is a handful of integer operations and relaxed atomic increments.
+ *
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Adds one sample.
+     *
+     * @param ns Duration in nanoseconds.
+     */
+    void record(uint64_t ns);
+
+    /**
+     * @brief Value at or below which the given percentage of samples fall.
+     *
+     * @param percentile 0 to 100.
+     * @return uint64_t Upper bound of the bucket holding that sample, in nanoseconds; 0 if empty.
+     */
+    uint64_t percentile(double percentile);
+
+    /**
+     * @brief Clears all samples. Samples recorded concurrently may be lost.
+     *
+     */
+    void reset();
+
+    /**
+     * @brief Writes the non-empty buckets, one per line, as lower bound, upper bound, and count.
+     *
+     */
+    void dump(FILE *fp);
+
+    uint64_t count();
+    uint64_t max();
+    double mean();
+
+private:
+    static int index(uint64_t ns);
+    static uint64_t lower(int idx);
+
+    std::atomic<uint64_t> buckets[LAT_BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> largest;
+};
+
+enum RX_LAT_STAGE
+{
+    RX_LAT_PARSE,  // Socket readable to frame parsed.
+    RX_LAT_HANDLE, // Frame parsed to handler done.
+    RX_LAT_RENDER, // Handler done to first rendered by the GUI.
+    RX_LAT_TOTAL,  // Socket readable to first rendered by the GUI.
+    RX_LAT_NUM
+};
+
+/**
+ * @brief Receive-path stage timings.
+ *
+ * The RX thread stamps cur_ready and cur_parsed for the frame being dispatched and records the first two stages. Messages handed to the GUI carry the ready and handled stamps; the GUI thread reports them through drained(...) and closes them out with rendered() once the frame has been swapped.
+ *
+ */
+class RxLatency
+{
+public:
+    RxLatency();
+
+    /**
+     * @brief GUI thread. Notes a message drained from the RX queue this frame.
+     *
+     */
+    void drained(uint64_t t_ready, uint64_t t_handled);
+
+    /**
+     * @brief GUI thread. Records the render stages for every message drained since the last call.
+     *
+     */
+    void rendered();
+
+    /**
+     * @brief Writes percentiles and the full bucket tables of every stage to a file.
+     *
+     * @return int 1 on success, negative on failure.
+     */
+    int dump(const char *filename);
+
+    void reset();
+
+    static const char *stage_name(int stage);
+
+    LatencyHistogram stage[RX_LAT_NUM];
+    uint64_t cur_ready;  // RX thread only.
+    uint64_t cur_parsed; // RX thread only.
+
+private:
+    uint64_t pending_ready[LAT_PENDING_MAX];
+    uint64_t pending_handled[LAT_PENDING_MAX];
+    int num_pending;
+};
+
+#endif // GS_LATENCY_HPP
@@ -0,0 +1,238 @@
+/**
+ * @file gs_log.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Asynchronous binary logger for hot paths.
+ *
+ * lgprintlf(...) copies the format pointer and raw argument bytes into a lock-free ring owned by the calling thread. A background writer thread formats and prints the records, so the caller never formats, locks, or flushes.
+ *
+ * Format strings must be string literals. String arguments are copied into the record (truncated to fit), so they need not outlive the call.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.25
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef GS_LOG_HPP
+#define GS_LOG_HPP
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include "meb_debug.hpp"
+
+#define GS_LOG_ARG_BYTES 128   // Raw argument storage per record.
+#define GS_LOG_RING_LEN 1024   // Records per thread; power of two.
+#define GS_LOG_IDLE_SLEEP 5000 // Writer sleep when all rings are empty, microseconds.
+
+struct gs_log_rec_t;
+typedef void (*gs_log_emit_t)(const gs_log_rec_t *rec, FILE *fp);
+
+/**
+ * @brief One deferred log line.
+ *
+ */
+struct gs_log_rec_t
+{
+    gs_log_emit_t emit;
+    const char *fmt;
+    const char *file;
+    const char *func;
+    int line;
+    bool truncated;
+    uint64_t ts_ns; // CLOCK_REALTIME at capture.
+    unsigned char args[GS_LOG_ARG_BYTES];
+};
+
+/**
+ * @brief Starts the background writer thread.
+ *
+ * @param fp Destination stream.
+ * @return int 1 on success, negative on failure.
+ */
+int gs_log_start(FILE *fp);
+
+/**
+ * @brief Drains every ring and stops the writer thread.
+ *
+ */
+void gs_log_stop();
+
+/**
+ * @brief Reserves the next record in the calling thread's ring.
+ *
+ * @return gs_log_rec_t* The record, or NULL if the ring is full (the message is counted as dropped).
+ */
+gs_log_rec_t *gs_log_reserve();
+
+/**
+ * @brief Publishes a record obtained from gs_log_reserve().
+ *
+ */
+void gs_log_commit();
+
+/**
+ * @brief Records captured since start.
+ *
+ */
+uint64_t gs_log_written();
+
+/**
+ * @brief Records dropped because a thread's ring was full.
+ *
+ */
+uint64_t gs_log_dropped();
+
+// Argument capture and replay. Strings are stored in-line, NUL terminated; everything else by value.
+
+static inline bool gs_log_put(unsigned char *&p, unsigned char *end, const char *v)
+{
+    if (v == NULL)
+    {
+        v = "(null)";
+    }
+    if (p >= end)
+    {
+        return false;
+    }
+    size_t room = end - p;
+    size_t len = strnlen(v, room - 1);
+    memcpy(p, v, len);
+    p[len] = '\0';
+    p += len + 1;
+    return true;
+}
+
+static inline bool gs_log_put(unsigned char *&p, unsigned char *end, char *v)
+{
+    return gs_log_put(p, end, (const char *)v);
+}
+
+template <typename T>
+static inline bool gs_log_put(unsigned char *&p, unsigned char *end, const T &v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "lgprintlf arguments must be trivially copyable.");
+    if ((size_t)(end - p) < sizeof(T))
+    {
+        return false;
+    }
+    memcpy(p, &v, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+template <typename T>
+struct gs_log_stored_as
+{
+    typedef T type;
+};
+
+template <>
+struct gs_log_stored_as<char *>
+{
+    typedef const char *type;
+};
+
+template <typename T>
+struct gs_log_stored
+{
+    typedef typename gs_log_stored_as<typename std::decay<T>::type>::type type;
+};
+
+template <typename T>
+static inline T gs_log_get(const unsigned char *&p)
+{
+    T v;
+    memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return v;
+}
+
+template <>
+inline const char *gs_log_get<const char *>(const unsigned char *&p)
+{
+    const char *v = (const char *)p;
+    p += strlen(v) + 1;
+    return v;
+}
+
+template <typename Tuple, size_t... I>
+static inline void gs_log_apply(FILE *fp, const char *fmt, const Tuple &t, std::index_sequence<I...>)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+    fprintf(fp, fmt, std::get<I>(t)...);
+#pragma GCC diagnostic pop
+}
+
+template <typename... Args>
+static void gs_log_emit(const gs_log_rec_t *rec, FILE *fp)
+{
+    const unsigned char *p = rec->args;
+    (void)p;
+    // Braced initialization guarantees left-to-right evaluation of the reads.
+    std::tuple<Args...> t{gs_log_get<Args>(p)...};
+    gs_log_apply(fp, rec->fmt, t, std::index_sequence_for<Args...>{});
+}
+
+static inline void gs_log_emit_raw(const gs_log_rec_t *rec, FILE *fp)
+{
+    fputs(rec->fmt, fp);
+}
+
+template <typename... Args>
+static inline void gs_log_capture(const char *file, int line, const char *func, const char *fmt, const Args &...args)
+{
+    gs_log_rec_t *rec = gs_log_reserve();
+    if (rec == NULL)
+    {
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    rec->fmt = fmt;
+    rec->file = file;
+    rec->func = func;
+    rec->line = line;
+    rec->ts_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+    unsigned char *p = rec->args;
+    unsigned char *end = rec->args + GS_LOG_ARG_BYTES;
+    bool ok = true;
+    bool results[] = {true, (ok = ok && gs_log_put(p, end, (typename gs_log_stored<Args>::type)args))...};
+    (void)results;
+    (void)end;
+    (void)p;
+
+    rec->truncated = !ok;
+    rec->emit = ok ? gs_log_emit<typename gs_log_stored<Args>::type...> : gs_log_emit_raw;
+
+    gs_log_commit();
+}
+
+// The printf(...) is never called; it only has the compiler check the format against the arguments, as it does for dbprintlf.
+#ifndef lgprintlf
+#define lgprintlf(format, ...)                                                                   \
+    do                                                                                           \
+    {                                                                                            \
+        if (0)                                                                                   \
+            printf(format, ##__VA_ARGS__);                                                       \
+        gs_log_capture(__FILE__, __LINE__, __func__, format "\x1b[0m\n", ##__VA_ARGS__);         \
+    } while (0)
+#endif // lgprintlf
+
+// Leveled, asynchronous versions of lgprintlf; see LOG_AT_* in meb_debug.hpp.
+#define lgprintlf_err(mod, format, ...) LOG_AT_ERR(mod, lgprintlf(format, ##__VA_ARGS__))
+#define lgprintlf_wrn(mod, format, ...) LOG_AT_WRN(mod, lgprintlf(format, ##__VA_ARGS__))
+#define lgprintlf_inf(mod, format, ...) LOG_AT_INF(mod, lgprintlf(format, ##__VA_ARGS__))
+#define lgprintlf_dbg(mod, format, ...) LOG_AT_DBG(mod, lgprintlf(format, ##__VA_ARGS__))
+#define lgprintlf_trc(mod, format, ...) LOG_AT_TRC(mod, lgprintlf(format, ##__VA_ARGS__))
+
+#endif // GS_LOG_HPP
@@ -0,0 +1,308 @@
+/**
+ * @file gs_rx.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Receive-path infrastructure used by gs_rx_thread.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef GS_RX_HPP
+#define GS_RX_HPP
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <atomic>
+#include "network.hpp"
+#include "gs_wire.hpp"
+
+#define RX_POOL_SIZE 16
+#define RX_STREAM_SIZE 0x10000 // Receive ring size in bytes; power of two, larger than GS_WIRE_MAX_FRAME_SIZE.
+
+/**
+ * @brief Read-only view of a received payload; valid until its frame is released back to the pool.
+ *
+ */
+typedef struct
+{
+    const unsigned char *data;
+    int size;
+} rx_payload_view_t;
+
+/**
+ * @brief A received frame with in-line payload storage.
+ *
+ */
+typedef struct
+{
+    gs_wire_hdr_t hdr;
+    gs_wire_ftr_t ftr;
+    unsigned char payload[GS_WIRE_MAX_PAYLOAD_SIZE];
+} rx_frame_t;
+
+/**
+ * @brief Fixed-size pool of pre-constructed receive frames, used to assemble frames that wrap around the end of the receive ring.
+ *
+ * Only the RX thread acquires and releases frames. The counters may be read from any thread.
+ *
+ */
+class RxFramePool
+{
+public:
+    RxFramePool();
+    ~RxFramePool();
+
+    /**
+     * @brief Takes a frame from the pool, falling back to the heap if the pool is exhausted.
+     *
+     * @return rx_frame_t* The frame.
+     */
+    rx_frame_t *acquire();
+
+    /**
+     * @brief Returns a frame to the pool (or frees it if it came from the heap).
+     *
+     * @param frame The frame.
+     */
+    void release(rx_frame_t *frame);
+
+    std::atomic<uint64_t> acquired;
+    std::atomic<uint64_t> released;
+    std::atomic<uint64_t> exhausted;   // Times acquire() found the pool empty.
+    std::atomic<uint64_t> heap_allocs; // Heap allocations made by the receive path.
+
+private:
+    rx_frame_t frames[RX_POOL_SIZE];
+    rx_frame_t *free_list[RX_POOL_SIZE];
+    int free_top;
+};
+
+// Event bits returned by RxEngine::wait(...).
+#define RX_EV_READABLE 0x1 // Server socket has data.
+#define RX_EV_HANGUP 0x2   // Server closed or reset the connection.
+#define RX_EV_WAKE 0x4     // Another thread called RxEngine::wake().
+#define RX_EV_TIMEOUT 0x8  // No data from the server for RECV_TIMEOUT seconds.
+#define RX_EV_ERROR 0x10   // epoll_wait(...) itself failed.
+
+/**
+ * @brief Event-driven I/O loop for the RX thread.
+ *
+ * Watches the server socket, a wakeup eventfd, and an inactivity timerfd in a single epoll set, so the RX thread reacts to data, disconnects, and shutdown requests as soon as they happen.
+ *
+ */
+class RxEngine
+{
+public:
+    RxEngine();
+    ~RxEngine();
+
+    /**
+     * @brief Starts watching a connected socket, replacing any previously watched one.
+     *
+     * @param socket The socket.
+     * @return int 1 on success, negative on failure.
+     */
+    int watch(int socket);
+
+    /**
+     * @brief Stops watching the current socket, if any.
+     *
+     */
+    void unwatch();
+
+    /**
+     * @brief (Re)arms the inactivity timer; zero disarms it.
+     *
+     * @param seconds Seconds of silence before RX_EV_TIMEOUT is raised.
+     */
+    void arm_timeout(int seconds);
+
+    /**
+     * @brief Interrupts wait(...) from any thread. Used on connect, disconnect, and shutdown.
+     *
+     */
+    void wake();
+
+    /**
+     * @brief Blocks until at least one event is pending.
+     *
+     * @param timeout_ms Milliseconds to wait, -1 for forever.
+     * @return int Bitwise OR of RX_EV_* values; zero if timeout_ms elapsed.
+     */
+    int wait(int timeout_ms);
+
+    int watched; // Currently watched socket, -1 if none.
+
+private:
+    int epfd;
+    int wakefd;
+    int timerfd;
+};
+
+/**
+ * @brief Returns a view of a frame's payload.
+ *
+ * @param frame The frame.
+ * @return rx_payload_view_t
+ */
+static inline rx_payload_view_t rx_frame_view(const rx_frame_t *frame)
+{
+    rx_payload_view_t view;
+    view.data = frame->payload;
+    view.size = frame->hdr.payload_size;
+    return view;
+}
+
+// Wildcard for the mod and cmd fields of a dispatch key.
+#define RX_ANY 0x100
+#define RX_DISPATCH_SLOTS 256 // Power of two.
+
+/**
+ * @brief Frame handler. The payload view is only valid for the duration of the call.
+ *
+ */
+typedef void (*rx_handler_t)(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload);
+
+/**
+ * @brief A registered handler and its call metrics.
+ *
+ */
+typedef struct
+{
+    bool used;
+    int type; // NetType
+    int mod;  // cmd_output_t::mod, or RX_ANY
+    int cmd;  // cmd_output_t::cmd, or RX_ANY
+    const char *name;
+    rx_handler_t fn;
+    void *ctx;
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> ns_total;
+    std::atomic<uint64_t> ns_max;
+} rx_handler_entry_t;
+
+/**
+ * @brief Handler registry keyed by (NetType, mod, cmd).
+ *
+ * Lookup tries (type, mod, cmd), then (type, mod, RX_ANY), then (type, RX_ANY, RX_ANY); each probe is a single hash-table lookup. The mod and cmd of DATA frames are read from the leading cmd_output_t fields; all other types dispatch on type alone.
+ *
+ * Handlers must be registered before the RX thread starts.
+ *
+ */
+class RxDispatcher
+{
+public:
+    RxDispatcher();
+
+    /**
+     * @brief Registers a handler for a key, replacing any existing handler for the same key.
+     *
+     * @return int 1 on success, negative if the table is full.
+     */
+    int register_handler(const char *name, NetType type, int mod, int cmd, rx_handler_t fn, void *ctx);
+
+    /**
+     * @brief Calls the most specific handler registered for a frame.
+     *
+     * @param hdr The received frame's header.
+     * @param payload The received frame's payload.
+     * @return int 1 if handled, 0 if no handler matched.
+     */
+    int dispatch(const gs_wire_hdr_t *hdr, rx_payload_view_t payload);
+
+    /**
+     * @brief Number of registered handlers.
+     *
+     */
+    int count();
+
+    /**
+     * @brief Registered handler by registration order, for display.
+     *
+     */
+    const rx_handler_entry_t *entry(int idx);
+
+    std::atomic<uint64_t> unhandled;
+
+private:
+    rx_handler_entry_t *find(int type, int mod, int cmd);
+
+    rx_handler_entry_t table[RX_DISPATCH_SLOTS];
+    int order[RX_DISPATCH_SLOTS];
+    int num_entries;
+};
+
+/**
+ * @brief A parsed frame. The header is a copy; the payload points into the receive ring, or into a pooled frame if the payload wrapped around the end of the ring.
+ *
+ * Valid until the next call to RxStream::fill(...), RxStream::next(...), or RxStream::reset().
+ *
+ */
+typedef struct
+{
+    gs_wire_hdr_t hdr;
+    rx_payload_view_t payload;
+} rx_frame_ref_t;
+
+/**
+ * @brief Buffers the server's byte stream in a ring and parses frames out of it in place.
+ *
+ * Each fill(...) moves everything the socket has (up to the free space in the ring) in a single non-blocking recvmsg(...), after which next(...) yields every complete frame without further syscalls. Misaligned or corrupt data is skipped one byte at a time until the next valid header.
+ *
+ * Used only by the RX thread. The counters may be read from any thread.
+ *
+ */
+class RxStream
+{
+public:
+    RxStream(RxFramePool *pool);
+    ~RxStream();
+
+    /**
+     * @brief Reads whatever the socket has available into the ring without blocking.
+     *
+     * @param socket Connected socket to read from.
+     * @return ssize_t Bytes read, 0 if nothing was available, -404 if the server closed the connection, -1 on error (see errno).
+     */
+    ssize_t fill(int socket);
+
+    /**
+     * @brief Parses the next complete frame out of the ring.
+     *
+     * @param ref Set to the frame on success.
+     * @return int 1 if a frame was parsed, 0 if more data is needed.
+     */
+    int next(rx_frame_ref_t *ref);
+
+    /**
+     * @brief Discards all buffered data. Must be called when the connection changes.
+     *
+     */
+    void reset();
+
+    std::atomic<uint64_t> reads;          // Successful recvmsg(...) calls.
+    std::atomic<uint64_t> bytes;          // Bytes read.
+    std::atomic<uint64_t> frames;         // Frames parsed.
+    std::atomic<uint64_t> wrapped;        // Frames whose payload was assembled in a pooled frame.
+    std::atomic<uint64_t> skipped;        // Bytes discarded while resynchronizing.
+    std::atomic<uint64_t> bad_frames;     // Frames with a valid GUID but an invalid header or footer.
+    std::atomic<uint64_t> crc_mismatches; // Frames accepted although their payload did not match crc1.
+    std::atomic<uint64_t> max_per_read;   // Most frames parsed out of a single fill(...).
+
+private:
+    void peek(size_t offset, void *dst, size_t len);
+    uint16_t crc(size_t offset, size_t len); // gs_wire_crc16(...) over stream bytes, across the wrap if need be.
+
+    RxFramePool *pool;
+    rx_frame_t *held; // Pooled frame backing the last wrapped payload, if any.
+    size_t head;      // Stream offset of the first unparsed byte.
+    size_t tail;      // Stream offset one past the last received byte.
+    int skip_run;     // Bytes skipped since the last good frame.
+    uint64_t frames_this_read;
+    unsigned char buf[RX_STREAM_SIZE];
+};
+
+#endif // GS_RX_HPP
@@ -0,0 +1,164 @@
+/**
+ * @file gs_sched.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Releases time-tagged commands at absolute UTC times, for pass automation.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef GS_SCHED_HPP
+#define GS_SCHED_HPP
+
+#include <stdint.h>
+#include <pthread.h>
+#include <atomic>
+#include "gs_tx.hpp"
+#include "gs_latency.hpp"
+#include "gs_cmd.hpp"
+
+#define SCHED_MAX_ENTRIES 256
+#define SCHED_DATA_LEN 46      // Matches cmd_input_t::data.
+#define SCHED_LATE_MAX 1000    // Milliseconds past its time after which a command is skipped instead of sent.
+
+// Life of a scheduled command.
+enum SCHED_STATE
+{
+    SCHED_STATE_WAITING = 0, // Loaded, not yet due.
+    SCHED_STATE_RELEASED,    // Handed to the TX engine.
+    SCHED_STATE_SKIPPED,     // Too late when its turn came, or the schedule was cancelled first.
+    SCHED_STATE_FAILED,      // The TX engine refused it.
+};
+
+/**
+ * @brief One line of a schedule file.
+ *
+ * The release thread fills in the release fields and then publishes them through state; the GUI thread owns the rest.
+ *
+ */
+typedef struct
+{
+    uint64_t t_sched;  // CLOCK_REALTIME (UTC) nanoseconds; resolved at arm() for relative entries.
+    uint64_t t_offset; // Nanoseconds after arm(), for relative entries.
+    bool relative;
+    int mod;
+    int cmd;
+    int origin; // TX_ORIGIN, from the module.
+    int cls;    // TX_CLASS, or -1 for the origin's default.
+    int data_size;
+    unsigned char data[SCHED_DATA_LEN];
+    int line; // Line in the schedule file.
+
+    std::atomic<int> state; // SCHED_STATE
+    uint64_t t_release;      // CLOCK_REALTIME when handed to the TX engine.
+    uint64_t t_release_mono; // lat_now_ns() at the same moment.
+    int tx_tag;
+
+    // GUI thread only.
+    uint32_t seq;    // CmdTracker sequence number, zero until tracked.
+    int result;      // CMD_STATUS once known; -1 before, -2 if it could not be tracked.
+    int retval;
+    uint64_t rtt;
+} sched_entry_t;
+
+/**
+ * @brief Loads a list of time-tagged commands and releases each at its absolute UTC time from a dedicated thread.
+ *
+ * Schedule files hold one command per line: a time, a module ID, a command ID, and up to 46 data bytes in hex. Times are either UTC, as YYYY-MM-DDTHH:MM:SS[.fff][Z], or +seconds relative to when the schedule is armed. Blank lines and lines starting with '#' are ignored.
+ *
+ *     2021-08-29T14:03:21.250Z 0x1 0x5
+ *     +12.5 0x3 0x2 01 00 00 00
+ *
+ * The release thread sleeps on a CLOCK_REALTIME timerfd armed at the command's absolute time, so wakeup jitter is a matter of scheduler latency rather than polling granularity, and a step in the system clock re-arms the wait rather than firing early or late.
+ *
+ * Load, arm, and cancel from the GUI thread only. The GUI cancels an armed schedule as soon as transmissions are locked or the operator's access level drops below required_access().
+ *
+ */
+class CmdScheduler
+{
+public:
+    CmdScheduler(TxEngine *tx);
+    ~CmdScheduler();
+
+    /**
+     * @brief Replaces the schedule with the contents of a file. Fails while armed.
+     *
+     * @param filename Schedule file.
+     * @param error Set to a description of the first problem on failure.
+     * @param error_len Size of error.
+     * @return int Number of commands loaded, negative on failure.
+     */
+    int load(const char *filename, char *error, int error_len);
+
+    /**
+     * @brief Starts the release thread. Relative times are counted from now.
+     *
+     * @return int 1 on success, negative on failure.
+     */
+    int arm();
+
+    /**
+     * @brief Stops the release thread; commands not yet released are skipped.
+     *
+     */
+    void cancel();
+
+    /**
+     * @brief Whether the release thread is running.
+     *
+     */
+    bool armed();
+
+    /**
+     * @brief Release thread body.
+     *
+     */
+    void run();
+
+    /**
+     * @brief GUI thread. Starts tracking released commands and collects their replies.
+     *
+     */
+    void collect(CmdTracker *tracker);
+
+    /**
+     * @brief The access level needed to arm the loaded schedule: that of its most privileged command.
+     *
+     */
+    int required_access();
+
+    int count();
+    sched_entry_t *entry(int idx); // In release order once armed, file order before.
+
+    static const char *state_name(int state);
+
+    LatencyHistogram jitter; // Release time minus scheduled time.
+    std::atomic<uint64_t> released;
+    std::atomic<uint64_t> skipped;
+
+private:
+    int wait_until(uint64_t t_sched);
+
+    TxEngine *tx;
+    sched_entry_t entries[SCHED_MAX_ENTRIES];
+    int order[SCHED_MAX_ENTRIES]; // Entry indices sorted by scheduled time.
+    int num_entries;
+    int min_access;
+
+    pthread_t thread;
+    bool thread_started;
+    std::atomic<bool> running;
+    int timerfd;
+    int wakefd;
+};
+
+/**
+ * @brief CLOCK_REALTIME in nanoseconds.
+ *
+ */
+uint64_t sched_utc_ns();
+
+#endif // GS_SCHED_HPP
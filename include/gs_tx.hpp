@@ -0,0 +1,357 @@
+/**
+ * @file gs_tx.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Transmit-path infrastructure used by gs_tx_thread.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.27
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef GS_TX_HPP
+#define GS_TX_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+#include "network.hpp"
+#include "gs_wire.hpp"
+#include "mpsc.hpp"
+#include "spsc.hpp"
+
+class CmdTracker;
+
+#define TX_FLOW_LEN 64 // Outbound frames waiting per flow; power of two.
+#define TX_EVENT_LEN 256 // Completion events waiting for the GUI; power of two.
+#define TX_BATCH_MAX 32  // Most queued frames coalesced into a single writev(...).
+#define TX_DRR_QUANTUM 512 // Bytes of credit per unit of weight per deficit round robin round.
+#define TX_WEIGHT_MAX 16
+#define TX_UHF_RATE_DEFAULT 600  // Payload bytes per second allowed onto the UHF uplink.
+#define TX_UHF_BURST_DEFAULT 224 // Payload bytes the UHF uplink may take back to back; four full commands.
+
+// Where a transmission came from, so each window can show the outcome of its own sends.
+enum TX_ORIGIN
+{
+    TX_ORIGIN_ACS = 0,
+    TX_ORIGIN_EPS,
+    TX_ORIGIN_XBAND,
+    TX_ORIGIN_SYS_CTRL,
+    TX_ORIGIN_SW_UPD,
+    TX_ORIGIN_CONFIG,
+    TX_ORIGIN_CONNS,
+    TX_ORIGIN_ACS_UPD,
+    TX_ORIGIN_KEEPALIVE,
+    TX_ORIGIN_NUM
+};
+
+// Uplink priority classes, highest first. A class is only served when every class above it is empty.
+enum TX_CLASS
+{
+    TX_CLASS_SAFETY = 0, // Aborts, reboots, restarts.
+    TX_CLASS_COMMAND,    // Operator commands and radio configuration.
+    TX_CLASS_POLL,       // Automated polls.
+    TX_CLASS_BULK,       // Software update transfer.
+    TX_CLASS_NUM
+};
+
+// Each origin is one flow in its default class; safety frames from any origin share one extra flow.
+#define TX_FLOW_SAFETY TX_ORIGIN_NUM
+#define TX_FLOW_NUM (TX_ORIGIN_NUM + 1)
+
+// Outcome of a transmission.
+enum TX_STATUS
+{
+    TX_STATUS_NONE = 0,      // Nothing sent yet.
+    TX_STATUS_SENT,          // Handed to the socket.
+    TX_STATUS_FAILED,        // The socket write failed; see err.
+    TX_STATUS_NOT_CONNECTED, // There was no connection to send on.
+};
+
+/**
+ * @brief An outbound frame, serialized into its queue slot by the submitting thread.
+ *
+ */
+typedef struct
+{
+    uint32_t tag;      // Unique per submission, never zero.
+    int origin;        // TX_ORIGIN
+    int cls;           // TX_CLASS
+    int type;          // NetType
+    int destination;   // NetVertex
+    int size;          // Payload bytes.
+    uint64_t t_submit; // lat_now_ns() at submission.
+    unsigned char payload[GS_WIRE_MAX_PAYLOAD_SIZE];
+} tx_req_t;
+
+/**
+ * @brief The outcome of one transmission, reported back to the GUI.
+ *
+ */
+typedef struct
+{
+    uint32_t tag;
+    int origin;
+    int type;
+    int status; // TX_STATUS
+    int err;    // errno, if status is TX_STATUS_FAILED.
+    uint64_t t_submit;
+    uint64_t t_done;
+} tx_event_t;
+
+/**
+ * @brief Token bucket limiting the payload bytes per second sent over a link.
+ *
+ * Only the TX thread takes tokens. The rate and burst may be changed from any thread.
+ *
+ */
+class TokenBucket
+{
+public:
+    TokenBucket(uint32_t rate, uint32_t burst);
+
+    /**
+     * @brief Any thread. Changes the limits; a rate of zero disables limiting.
+     *
+     */
+    void set(uint32_t rate, uint32_t burst);
+
+    /**
+     * @brief Whether cost tokens are available now.
+     *
+     * @param wait_ns Set to the nanoseconds until they will be, if not.
+     */
+    bool available(int cost, uint64_t now, uint64_t *wait_ns);
+
+    /**
+     * @brief Takes cost tokens, going into debt if there are not enough.
+     *
+     * @return true if the bucket went into debt.
+     */
+    bool take(int cost, uint64_t now);
+
+    /**
+     * @brief Returns cost tokens taken for a frame that never reached the link, up to the burst.
+     *
+     */
+    void refund(int cost);
+
+    std::atomic<uint32_t> rate;  // Tokens (bytes) per second.
+    std::atomic<uint32_t> burst; // Most tokens the bucket holds.
+    std::atomic<int64_t> level;  // Tokens after the last refill, for display; negative while in debt.
+
+private:
+    void refill(uint64_t now);
+
+    double tokens;
+    uint64_t t_last;
+};
+
+/**
+ * @brief Hands outbound frames from any thread to the TX thread, which alone writes to the socket, and reports completions back to the GUI.
+ *
+ * Submitting never blocks: the frame is copied into a lock-free queue slot of its flow and the TX thread is woken through an eventfd.
+ *
+ * The TX thread drains flows by strict priority between classes (TX_CLASS), and by deficit round robin between the flows of a class, so flows share their class's bandwidth in proportion to their weights.
+ *
+ * Everything addressed to the roof UHF radio also passes through one token bucket sized to the UHF link budget. A flow whose next frame does not fit waits without holding up flows to other destinations; safety frames are never held and put the bucket into debt instead.
+ *
+ */
+class TxEngine
+{
+public:
+    TxEngine();
+    ~TxEngine();
+
+    /**
+     * @brief Any thread. Queues a frame for transmission.
+     *
+     * @param payload Payload bytes; may be NULL if size is zero.
+     * @param size Payload size.
+     * @param type NetType of the frame.
+     * @param destination NetVertex of the frame.
+     * @param origin TX_ORIGIN of the caller.
+     * @param cls TX_CLASS; omit for the origin's default class. Only TX_CLASS_SAFETY may differ from the default.
+     * @return int The submission's tag (positive) on success, negative if the payload is too large or the flow's queue is full.
+     */
+    int submit(const void *payload, int size, NetType type, NetVertex destination, int origin, int cls = -1);
+
+    /**
+     * @brief Any thread. Queues a payload struct (cmd_input_t, xband_set_data_t, phy_config_t, ...) for transmission; its size is taken from its type.
+     *
+     * Only struct payloads select this overload, so byte buffers and NULL still go to submit(payload, size, ...).
+     *
+     * @return int The submission's tag (positive) on success, negative if the flow's queue is full.
+     */
+    template <typename T, typename = typename std::enable_if<std::is_class<T>::value>::type>
+    int submit(const T &payload, NetType type, NetVertex destination, int origin, int cls = -1)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Payloads are copied byte for byte.");
+        static_assert(sizeof(T) <= GS_WIRE_MAX_PAYLOAD_SIZE, "Payload does not fit in a frame.");
+        return submit(&payload, sizeof(T), type, destination, origin, cls);
+    }
+
+    /**
+     * @brief Any thread. Reserves a queue slot and returns its payload area, so the payload can be built in place without a staging copy.
+     *
+     * The slot must be passed to commit(...) promptly, even if the frame is no longer wanted: the TX thread cannot get past it until then.
+     *
+     * @param origin TX_ORIGIN of the caller.
+     * @param cls TX_CLASS; omit for the origin's default class.
+     * @return T* Zero-filled payload area, or NULL if the flow's queue is full.
+     */
+    template <typename T>
+    T *reserve(int origin, int cls = -1)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Payloads are copied byte for byte.");
+        static_assert(sizeof(T) <= GS_WIRE_MAX_PAYLOAD_SIZE, "Payload does not fit in a frame.");
+        tx_req_t *req = reserve_slot(origin, cls);
+        if (req == NULL)
+        {
+            return NULL;
+        }
+        memset(req->payload, 0x0, sizeof(T));
+        return (T *)req->payload;
+    }
+
+    /**
+     * @brief Any thread. Queues a payload built in a slot from reserve(...).
+     *
+     * @return int The submission's tag (positive).
+     */
+    template <typename T>
+    int commit(T *payload, NetType type, NetVertex destination)
+    {
+        return commit_slot((tx_req_t *)((unsigned char *)payload - offsetof(tx_req_t, payload)), sizeof(T), type, destination);
+    }
+
+    /**
+     * @brief TX thread. Blocks until a frame is queued or wake() is called.
+     *
+     * @param timeout_ms Milliseconds to wait, -1 for forever.
+     */
+    void wait(int timeout_ms);
+
+    /**
+     * @brief Any thread. Interrupts wait(...), e.g. at shutdown.
+     *
+     */
+    void wake();
+
+    /**
+     * @brief Any thread. Tells the TX thread to exit.
+     *
+     */
+    void stop();
+
+    /**
+     * @brief TX thread. Picks the next frames to send, leaving them in their slots.
+     *
+     * @param batch Filled with up to max frames, in sending order.
+     * @param flows Filled with the flow of each frame.
+     * @param max At most TX_BATCH_MAX.
+     * @return int Number of frames picked.
+     */
+    int schedule(tx_req_t **batch, int *flows, int max);
+
+    /**
+     * @brief TX thread. How long the last schedule(...) left frames waiting on the UHF token bucket.
+     *
+     * @return int Milliseconds until the first waiting frame may be sent, -1 if none are waiting.
+     */
+    int throttle_wait_ms();
+
+    /**
+     * @brief TX thread. Frees the oldest slot of a flow; call once per scheduled frame, in order, after it has been completed.
+     *
+     */
+    void pop(int flow);
+
+    /**
+     * @brief TX thread. Records a frame's outcome and reports it to the GUI.
+     *
+     */
+    void complete(const tx_req_t *req, int status, int err);
+
+    /**
+     * @brief GUI thread. Collects completion events into last_event(...).
+     *
+     * @param tracker If not NULL, commands whose frames failed or found no connection are finished there as not sent.
+     * @return int Number of events collected.
+     */
+    int drain_events(CmdTracker *tracker = NULL);
+
+    /**
+     * @brief GUI thread. The most recent completion for an origin; status is TX_STATUS_NONE if there has been none.
+     *
+     */
+    const tx_event_t *last_event(int origin);
+
+    size_t queued();
+    size_t queued(int flow);
+
+    /**
+     * @brief Sets a flow's share of its class; any thread.
+     *
+     */
+    void set_weight(int flow, int weight);
+    int weight(int flow);
+
+    static int flow_class(int flow);
+    static const char *flow_name(int flow);
+    static const char *class_name(int cls);
+    static const char *origin_name(int origin);
+    static const char *status_name(int status);
+
+    std::atomic<bool> active; // Cleared by stop().
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> rejected; // Submissions refused because a flow's queue was full.
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> failed; // Includes frames dropped for lack of a connection.
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> writes;    // writev(...) calls.
+    std::atomic<uint64_t> coalesced; // Frames that shared a writev(...) with at least one other frame.
+    std::atomic<uint64_t> max_batch; // Most frames sent in one writev(...).
+    std::atomic<uint64_t> events_lost; // Completions the GUI did not collect in time.
+    std::atomic<uint64_t> flow_sent[TX_FLOW_NUM];
+    std::atomic<uint64_t> class_sent[TX_CLASS_NUM];
+    std::atomic<uint64_t> throttled; // Times schedule(...) held frames back for the UHF link budget.
+    std::atomic<uint64_t> uhf_debt;  // Safety frames sent without enough UHF tokens.
+
+    TokenBucket uhf;
+
+private:
+    bool hold(const tx_req_t *req, uint64_t now, uint64_t *wait_ns);
+
+    tx_req_t *reserve_slot(int origin, int cls);
+    int commit_slot(tx_req_t *req, int size, NetType type, NetVertex destination);
+
+    MPSCQueue<tx_req_t, TX_FLOW_LEN> queue[TX_FLOW_NUM];
+    std::atomic<int> weights[TX_FLOW_NUM];
+    int deficit[TX_FLOW_NUM]; // TX thread only.
+    int rr_next[TX_CLASS_NUM]; // TX thread only; flow each class's next round starts from.
+    bool rr_granted[TX_CLASS_NUM]; // TX thread only; rr_next already received its quantum this turn.
+    uint64_t hold_ns; // TX thread only; wait reported by throttle_wait_ms(), zero if nothing is held.
+    SPSCRing<tx_event_t, TX_EVENT_LEN> events;
+    tx_event_t last[TX_ORIGIN_NUM]; // GUI thread only.
+    std::atomic<uint32_t> next_tag;
+    int wakefd;
+};
+
+/**
+ * @brief Serializes and writes a batch of frames with a single writev(...) where possible.
+ *
+ * Payloads are written straight from their queue slots. A lone frame is written immediately; a batch is corked so it leaves in as few TCP segments as possible.
+ *
+ * @param socket Connected socket.
+ * @param reqs Frames to send, in order.
+ * @param count Number of frames, at most TX_BATCH_MAX.
+ * @param writes Incremented once per writev(...) call.
+ * @return int Number of leading frames written completely. If less than count, errno is set and the batch was abandoned, possibly partway through a frame, so the connection is no longer usable.
+ */
+int gs_tx_write_batch(int socket, tx_req_t *const *reqs, int count, std::atomic<uint64_t> *writes);
+
+#endif // GS_TX_HPP
@@ -0,0 +1,172 @@
+/**
+ * @file gs_wire.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief On-the-wire layout of a serialized NetFrame.
+ *
+ * Mirrors the field-by-field serialization performed by NetFrame::sendFrame(...) in the network submodule, so the client can parse and build frames in its own buffers instead of round-tripping through heap-allocated NetFrame objects.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef GS_WIRE_HPP
+#define GS_WIRE_HPP
+
+#include <stdint.h>
+
+#ifndef GS_WIRE_GUID
+#define GS_WIRE_GUID 0x1A1C
+#endif // GS_WIRE_GUID
+
+#ifndef GS_WIRE_TERMINATOR
+#define GS_WIRE_TERMINATOR 0xAAAA
+#endif // GS_WIRE_TERMINATOR
+
+// Largest payload the client will accept; generously above anything the Network currently sends.
+#define GS_WIRE_MAX_PAYLOAD_SIZE 0x400
+
+/**
+ * @brief Serialized NetFrame header, precedes the payload.
+ *
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t guid;        // GS_WIRE_GUID
+    int32_t origin;       // NetVertex
+    int32_t destination;  // NetVertex
+    int32_t type;         // NetType
+    int32_t payload_size; // Bytes of payload following this header.
+    uint8_t netstat;      // Network status bits, set by the server.
+    uint16_t crc1;        // CRC16 of the payload.
+} gs_wire_hdr_t;
+
+/**
+ * @brief Serialized NetFrame footer, follows the payload.
+ *
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t crc2;        // Repeat of crc1.
+    uint16_t termination; // GS_WIRE_TERMINATOR
+} gs_wire_ftr_t;
+
+#define GS_WIRE_OVERHEAD (sizeof(gs_wire_hdr_t) + sizeof(gs_wire_ftr_t))
+#define GS_WIRE_MAX_FRAME_SIZE (GS_WIRE_OVERHEAD + GS_WIRE_MAX_PAYLOAD_SIZE)
+
+/**
+ * @brief Checks a received header for a sane GUID and payload size.
+ *
+ * @param hdr The header to check.
+ * @return int 1 if valid, negative if not.
+ */
+static inline int gs_wire_check_hdr(const gs_wire_hdr_t *hdr)
+{
+    if (hdr->guid != GS_WIRE_GUID)
+    {
+        return -1;
+    }
+    if (hdr->payload_size < 0 || hdr->payload_size > GS_WIRE_MAX_PAYLOAD_SIZE)
+    {
+        return -2;
+    }
+    return 1;
+}
+
+/**
+ * @brief Advances the CRC register of crc16() in gs.hpp over more bytes: reflected CCITT polynomial 0x8408, initial register 0xFFFF.
+ *
+ * Split from gs_wire_crc16_final(...) so a checksum can be carried across discontiguous pieces of one payload.
+ *
+ * @param reg Register after the preceding bytes; 0xFFFF to start.
+ * @param data Bytes to checksum; may be NULL if size is zero.
+ * @param size Number of bytes.
+ * @return uint16_t The register after data.
+ */
+static inline uint16_t gs_wire_crc16_update(uint16_t reg, const unsigned char *data, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        unsigned int byte = data[i];
+        for (int bit = 0; bit < 8; bit++, byte >>= 1)
+        {
+            if ((reg ^ byte) & 0x0001)
+                reg = (reg >> 1) ^ 0x8408;
+            else
+                reg >>= 1;
+        }
+    }
+    return reg;
+}
+
+/**
+ * @brief Turns a register from gs_wire_crc16_update(...) into the checksum: inverted, then byte-swapped, as crc16() in gs.hpp does.
+ *
+ */
+static inline uint16_t gs_wire_crc16_final(uint16_t reg)
+{
+    reg = ~reg;
+    return (uint16_t)((reg << 8) | (reg >> 8));
+}
+
+/**
+ * @brief The checksum NetFrame carries in crc1 and crc2; bit for bit the crc16() of gs.hpp, which gs_wire.hpp cannot include.
+ *
+ * @param data Bytes to checksum; may be NULL if size is zero.
+ * @param size Number of bytes.
+ * @return uint16_t The checksum.
+ */
+static inline uint16_t gs_wire_crc16(const unsigned char *data, int size)
+{
+    return gs_wire_crc16_final(gs_wire_crc16_update(0xFFFF, data, size));
+}
+
+/**
+ * @brief Checks a received footer against its header.
+ *
+ * The payload's own checksum is not part of the check: gs_wire_crc16(...) follows crc16() in gs.hpp, which has not yet been confirmed against a frame from NetFrame, so a mismatch is counted rather than rejected (see RxStream::crc_mismatches).
+ *
+ * @param hdr The header of the frame.
+ * @param ftr The footer of the frame.
+ * @return int 1 if valid, negative if not.
+ */
+static inline int gs_wire_check_ftr(const gs_wire_hdr_t *hdr, const gs_wire_ftr_t *ftr)
+{
+    if (ftr->termination != GS_WIRE_TERMINATOR)
+    {
+        return -1;
+    }
+    if (ftr->crc2 != hdr->crc1)
+    {
+        return -2;
+    }
+    return 1;
+}
+
+/**
+ * @brief Fills in the header and footer for an outbound payload.
+ *
+ * @param hdr Header to fill.
+ * @param ftr Footer to fill.
+ * @param origin NetVertex of the sender.
+ * @param destination NetVertex of the recipient.
+ * @param type NetType of the frame.
+ * @param payload Payload bytes; may be NULL if size is zero.
+ * @param size Payload size.
+ */
+static inline void gs_wire_frame(gs_wire_hdr_t *hdr, gs_wire_ftr_t *ftr, int origin, int destination, int type, const unsigned char *payload, int size)
+{
+    hdr->guid = GS_WIRE_GUID;
+    hdr->origin = origin;
+    hdr->destination = destination;
+    hdr->type = type;
+    hdr->payload_size = size;
+    hdr->netstat = 0;
+    hdr->crc1 = gs_wire_crc16(payload, size);
+    ftr->crc2 = hdr->crc1;
+    ftr->termination = GS_WIRE_TERMINATOR;
+}
+
+#endif // GS_WIRE_HPP
@@ -30,6 +30,125 @@
     fflush(stderr);
 #endif // erprintlf
 
+// Log levels. Messages above GS_LOG_LEVEL are removed at compile time; those at or below it can be switched per module at runtime.
+#define LOG_LVL_NONE 0
+#define LOG_LVL_ERR 1
+#define LOG_LVL_WRN 2
+#define LOG_LVL_INF 3
+#define LOG_LVL_DBG 4
+#define LOG_LVL_TRC 5
+#define LOG_LVL_COUNT 5
+
+#ifndef GS_LOG_LEVEL
+#define GS_LOG_LEVEL LOG_LVL_TRC
+#endif // GS_LOG_LEVEL
+
+// Log modules.
+#define LOG_MOD_GEN 0   // General / startup.
+#define LOG_MOD_RX 1    // Receive thread and frame handlers.
+#define LOG_MOD_TX 2    // Outbound frames.
+#define LOG_MOD_SWUPD 3 // Software update transfer.
+#define LOG_MOD_GUI 4   // ImGui windows.
+#define LOG_MOD_COUNT 5
+
+#ifdef __cplusplus
+#include <atomic>
+#include <stdint.h>
+
+// One bit per (module, level); a message is printed if its bit is set.
+#define LOG_BIT(mod, lvl) (1u << ((mod) * LOG_LVL_COUNT + (lvl) - 1))
+
+inline std::atomic<uint32_t> meb_log_mask(0xffffffff);
+
+/**
+ * @brief Enables every level up to and including max_lvl for a module, and disables the rest.
+ * 
+ */
+static inline void meb_log_set_level(int mod, int max_lvl)
+{
+    uint32_t bits = 0;
+    for (int lvl = LOG_LVL_ERR; lvl <= LOG_LVL_COUNT; lvl++)
+    {
+        if (lvl <= max_lvl)
+        {
+            bits |= LOG_BIT(mod, lvl);
+        }
+    }
+    uint32_t keep = ~(((1u << LOG_LVL_COUNT) - 1) << (mod * LOG_LVL_COUNT));
+    uint32_t mask = meb_log_mask.load(std::memory_order_relaxed);
+    meb_log_mask.store((mask & keep) | bits, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Highest level currently enabled for a module.
+ * 
+ */
+static inline int meb_log_get_level(int mod)
+{
+    uint32_t mask = meb_log_mask.load(std::memory_order_relaxed);
+    int max_lvl = LOG_LVL_NONE;
+    for (int lvl = LOG_LVL_ERR; lvl <= LOG_LVL_COUNT; lvl++)
+    {
+        if (mask & LOG_BIT(mod, lvl))
+        {
+            max_lvl = lvl;
+        }
+    }
+    return max_lvl;
+}
+
+#define LOG_ON(mod, lvl) (meb_log_mask.load(std::memory_order_relaxed) & LOG_BIT(mod, lvl))
+#else
+#define LOG_ON(mod, lvl) 1
+#endif // __cplusplus
+
+// LOG_AT_<level>(mod, statement) runs statement only if the level is compiled in and enabled for the module.
+#define LOG_AT(mod, lvl, stmt) \
+    do                         \
+    {                          \
+        if (LOG_ON(mod, lvl))  \
+        {                      \
+            stmt;              \
+        }                      \
+    } while (0)
+#define LOG_NOP() \
+    do            \
+    {             \
+    } while (0)
+
+#if GS_LOG_LEVEL >= LOG_LVL_ERR
+#define LOG_AT_ERR(mod, stmt) LOG_AT(mod, LOG_LVL_ERR, stmt)
+#else
+#define LOG_AT_ERR(mod, stmt) LOG_NOP()
+#endif
+#if GS_LOG_LEVEL >= LOG_LVL_WRN
+#define LOG_AT_WRN(mod, stmt) LOG_AT(mod, LOG_LVL_WRN, stmt)
+#else
+#define LOG_AT_WRN(mod, stmt) LOG_NOP()
+#endif
+#if GS_LOG_LEVEL >= LOG_LVL_INF
+#define LOG_AT_INF(mod, stmt) LOG_AT(mod, LOG_LVL_INF, stmt)
+#else
+#define LOG_AT_INF(mod, stmt) LOG_NOP()
+#endif
+#if GS_LOG_LEVEL >= LOG_LVL_DBG
+#define LOG_AT_DBG(mod, stmt) LOG_AT(mod, LOG_LVL_DBG, stmt)
+#else
+#define LOG_AT_DBG(mod, stmt) LOG_NOP()
+#endif
+#if GS_LOG_LEVEL >= LOG_LVL_TRC
+#define LOG_AT_TRC(mod, stmt) LOG_AT(mod, LOG_LVL_TRC, stmt)
+#else
+#define LOG_AT_TRC(mod, stmt) LOG_NOP()
+#endif
+
+// Leveled, synchronous versions of dbprintlf.
+#define dbprintlf_err(mod, format, ...) LOG_AT_ERR(mod, dbprintlf(format, ##__VA_ARGS__))
+#define dbprintlf_wrn(mod, format, ...) LOG_AT_WRN(mod, dbprintlf(format, ##__VA_ARGS__))
+#define dbprintlf_inf(mod, format, ...) LOG_AT_INF(mod, dbprintlf(format, ##__VA_ARGS__))
+#define dbprintlf_dbg(mod, format, ...) LOG_AT_DBG(mod, dbprintlf(format, ##__VA_ARGS__))
+#define dbprintlf_trc(mod, format, ...) LOG_AT_TRC(mod, dbprintlf(format, ##__VA_ARGS__))
+
 #ifndef MEB_COLORS
 #define MEB_COLORS
 #define RESET_ALL "\x1b[0m"
@@ -0,0 +1,163 @@
+/**
+ * @file mpsc.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Lock-free bounded multi-producer / single-consumer queue.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.27
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef MPSC_HPP
+#define MPSC_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define MPSC_CACHELINE 64
+
+/**
+ * @brief Bounded queue with any number of producer threads and exactly one consumer thread (after D. Vyukov's bounded MPMC queue).
+ *
+ * Producers claim a slot, fill it in place, then publish it; the consumer reads the oldest slot in place, then frees it. Nobody ever blocks or takes a lock, and nothing is copied through an intermediate buffer. N must be a power of two.
+ *
+ * @tparam T Item type.
+ * @tparam N Capacity.
+ */
+template <typename T, size_t N>
+class MPSCQueue
+{
+    static_assert((N & (N - 1)) == 0, "MPSCQueue capacity must be a power of two.");
+
+public:
+    MPSCQueue() : enqueue_pos(0), dequeue_pos(0)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Producer side. Claims the next free slot.
+     *
+     * @return T* Slot to fill in, then pass to commit(...); NULL if the queue is full.
+     */
+    T *reserve()
+    {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell_t *cell = &cells[pos & (N - 1)];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+            if (dif == 0)
+            {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    return &cell->data;
+                }
+            }
+            else if (dif < 0)
+            {
+                return NULL;
+            }
+            else
+            {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Producer side. Publishes a slot obtained from reserve().
+     *
+     */
+    void commit(T *item)
+    {
+        cell_t *cell = (cell_t *)item;
+        size_t seq = cell->seq.load(std::memory_order_relaxed);
+        cell->seq.store(seq + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer side. The oldest published item, left in place.
+     *
+     * @return T* The item, or NULL if the queue is empty (or the oldest slot is claimed but not yet committed).
+     */
+    T *front()
+    {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        cell_t *cell = &cells[pos & (N - 1)];
+        if (cell->seq.load(std::memory_order_acquire) != pos + 1)
+        {
+            return NULL;
+        }
+        return &cell->data;
+    }
+
+    /**
+     * @brief Consumer side. The idx-th oldest published item, left in place.
+     *
+     * @return T* The item, or NULL if fewer than idx + 1 consecutive items are published.
+     */
+    T *peek(size_t idx)
+    {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed) + idx;
+        if (idx >= N)
+        {
+            return NULL;
+        }
+        cell_t *cell = &cells[pos & (N - 1)];
+        if (cell->seq.load(std::memory_order_acquire) != pos + 1)
+        {
+            return NULL;
+        }
+        return &cell->data;
+    }
+
+    /**
+     * @brief Consumer side. Frees the slot returned by front().
+     *
+     */
+    void pop()
+    {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        cell_t *cell = &cells[pos & (N - 1)];
+        cell->seq.store(pos + N, std::memory_order_release);
+        dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Approximate number of claimed slots.
+     *
+     */
+    size_t size()
+    {
+        size_t e = enqueue_pos.load(std::memory_order_relaxed);
+        size_t d = dequeue_pos.load(std::memory_order_relaxed);
+        return e > d ? e - d : 0;
+    }
+
+    size_t capacity()
+    {
+        return N;
+    }
+
+private:
+    typedef struct
+    {
+        T data; // First, so a T* from reserve() is also the cell's address.
+        std::atomic<size_t> seq;
+    } cell_t;
+
+    alignas(MPSC_CACHELINE) std::atomic<size_t> enqueue_pos;
+    alignas(MPSC_CACHELINE) std::atomic<size_t> dequeue_pos; // Written only by the consumer.
+    alignas(MPSC_CACHELINE) cell_t cells[N];
+};
+
+#endif // MPSC_HPP
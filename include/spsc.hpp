@@ -0,0 +1,192 @@
+/**
+ * @file spsc.hpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Lock-free single-producer / single-consumer ring.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef SPSC_HPP
+#define SPSC_HPP
+
+#include <stddef.h>
+#include <atomic>
+
+#define SPSC_CACHELINE 64
+
+/**
+ * @brief Bounded ring of trivially copyable items with exactly one producer thread and one consumer thread.
+ *
+ * Neither side ever blocks or takes a lock. N must be a power of two.
+ *
+ * @tparam T Item type.
+ * @tparam N Capacity.
+ */
+template <typename T, size_t N>
+class SPSCRing
+{
+    static_assert((N & (N - 1)) == 0, "SPSCRing capacity must be a power of two.");
+
+public:
+    SPSCRing() : head(0), tail(0) {}
+
+    /**
+     * @brief Producer side. Copies an item into the ring.
+     *
+     * @return true if queued, false if the ring is full.
+     */
+    bool push(const T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= N)
+        {
+            return false;
+        }
+        buf[t & (N - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side. Copies the oldest item out of the ring.
+     *
+     * @return true if an item was dequeued, false if the ring is empty.
+     */
+    bool pop(T *item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        *item = buf[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Approximate number of queued items; exact when called from either endpoint thread.
+     *
+     */
+    size_t size()
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity()
+    {
+        return N;
+    }
+
+private:
+    alignas(SPSC_CACHELINE) std::atomic<size_t> head; // Written only by the consumer.
+    alignas(SPSC_CACHELINE) std::atomic<size_t> tail; // Written only by the producer.
+    alignas(SPSC_CACHELINE) T buf[N];
+};
+
+/**
+ * @brief Bounded single-producer / single-consumer ring whose producer may discard the oldest item to make room.
+ *
+ * The consumer copies an item out and then claims it with a compare-and-swap on head; if the producer evicted that item in the meantime (possibly overwriting it mid-copy), the claim fails and the consumer retries with the new oldest item. N must be a power of two. T must be trivially copyable.
+ *
+ * @tparam T Item type.
+ * @tparam N Capacity.
+ */
+template <typename T, size_t N>
+class SPSCEvictRing
+{
+    static_assert((N & (N - 1)) == 0, "SPSCEvictRing capacity must be a power of two.");
+
+public:
+    SPSCEvictRing() : head(0), tail(0) {}
+
+    /**
+     * @brief Producer side. Copies an item into the ring.
+     *
+     * @return true if queued, false if the ring is full.
+     */
+    bool push(const T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= N)
+        {
+            return false;
+        }
+        buf[t & (N - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Producer side. Copies an item into the ring, discarding the oldest item if the ring is full.
+     *
+     * @return true if an item was discarded to make room.
+     */
+    bool push_evict(const T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        bool evicted = false;
+
+        // If the consumer takes the oldest item first, the ring is no longer full and the CAS fails harmlessly.
+        while (t - h >= N)
+        {
+            if (head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                evicted = true;
+                break;
+            }
+        }
+
+        buf[t & (N - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return evicted;
+    }
+
+    /**
+     * @brief Consumer side. Copies the oldest item out of the ring.
+     *
+     * @return true if an item was dequeued, false if the ring is empty.
+     */
+    bool pop(T *item)
+    {
+        size_t h = head.load(std::memory_order_acquire);
+        while (h != tail.load(std::memory_order_acquire))
+        {
+            *item = buf[h & (N - 1)];
+            if (head.compare_exchange_strong(h, h + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                return true;
+            }
+            // Evicted while we were copying it; h now holds the new head.
+        }
+        return false;
+    }
+
+    /**
+     * @brief Approximate number of queued items; exact when called from either endpoint thread.
+     *
+     */
+    size_t size()
+    {
+        size_t t = tail.load(std::memory_order_acquire);
+        size_t h = head.load(std::memory_order_acquire);
+        return t > h ? t - h : 0;
+    }
+
+    size_t capacity()
+    {
+        return N;
+    }
+
+private:
+    alignas(SPSC_CACHELINE) std::atomic<size_t> head; // Advanced by the consumer, or by the producer when evicting.
+    alignas(SPSC_CACHELINE) std::atomic<size_t> tail; // Written only by the producer.
+    alignas(SPSC_CACHELINE) T buf[N];
+};
+
+#endif // SPSC_HPP
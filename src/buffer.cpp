@@ -9,95 +9,535 @@
  * 
  */
 
+#include <math.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
 #include "buffer.hpp"
+#include "gs_half.hpp"
+#include "meb_debug.hpp"
 
-ScrollBuf::ScrollBuf()
+TelemetryStore::TelemetryStore(int num_channels, int capacity)
 {
-    max_sz = 600;
-    ofst = 0;
-    data.reserve(max_sz);
+    num_ch = num_channels;
+    cap = capacity;
+    t_mono = new uint64_t[cap];
+    t_utc = new uint64_t[cap];
+    cols = new float[num_ch * cap];
+    dq_slots = new int[2 * num_ch * cap];
+    dq_head = new int[2 * num_ch];
+    dq_len = new int[2 * num_ch];
+
+    static const uint64_t intervals[TELEM_TIERS] = {10000000000ULL, 60000000000ULL, 600000000000ULL};
+    for (int i = 0; i < TELEM_TIERS; i++)
+    {
+        telem_tier_t *tr = &tiers[i];
+        tr->interval = intervals[i];
+        tr->t_utc = new uint64_t[TELEM_TIER_LEN];
+        tr->min = new float[num_ch * TELEM_TIER_LEN];
+        tr->max = new float[num_ch * TELEM_TIER_LEN];
+        tr->mean = new float[num_ch * TELEM_TIER_LEN];
+        tr->n = new int[num_ch * TELEM_TIER_LEN];
+    }
+
+    clear();
+}
+
+TelemetryStore::~TelemetryStore()
+{
+    delete[] t_mono;
+    delete[] t_utc;
+    delete[] cols;
+    delete[] dq_slots;
+    delete[] dq_head;
+    delete[] dq_len;
+
+    for (int i = 0; i < TELEM_TIERS; i++)
+    {
+        delete[] tiers[i].t_utc;
+        delete[] tiers[i].min;
+        delete[] tiers[i].max;
+        delete[] tiers[i].mean;
+        delete[] tiers[i].n;
+    }
 }
 
-ScrollBuf::ScrollBuf(int max_size)
+// Retires the row about to be overwritten from the front of every deque.
+void TelemetryStore::advance()
 {
-    max_sz = max_size;
-    ofst = 0;
-    data.reserve(max_sz);
+    if (count < cap)
+        return;
+
+    for (int dq = 0; dq < 2 * num_ch; dq++)
+    {
+        if (dq_len[dq] > 0 && dq_slots[dq * cap + dq_head[dq]] == head)
+        {
+            dq_head[dq] = (dq_head[dq] + 1) % cap;
+            dq_len[dq]--;
+        }
+    }
 }
 
-void ScrollBuf::AddPoint(float x, float y)
+// Drops rows from the back that can no longer be the extreme, then appends the newest.
+void TelemetryStore::extend(int dq, int slot, float value, bool want_max)
 {
-    if (data.size() < max_sz)
-        data.push_back(ImVec2(x, y));
+    int *slots = &dq_slots[dq * cap];
+    const float *y = column(dq / 2);
+
+    while (dq_len[dq] > 0)
+    {
+        float back = y[slots[(dq_head[dq] + dq_len[dq] - 1) % cap]];
+        if (want_max ? back > value : back < value)
+            break;
+        dq_len[dq]--;
+    }
+
+    slots[(dq_head[dq] + dq_len[dq]) % cap] = slot;
+    dq_len[dq]++;
+}
+
+// Moves the left edge of the deques to start: forward by popping fronts, back by rebuilding from the rows held.
+void TelemetryStore::window(double start)
+{
+    if (start == dq_start)
+        return;
+
+    if (start < dq_start)
+    {
+        for (int dq = 0; dq < 2 * num_ch; dq++)
+        {
+            dq_head[dq] = 0;
+            dq_len[dq] = 0;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            int slot = (offset() + i) % cap;
+            if (seconds(slot) < start)
+                continue;
+            for (int ch = 0; ch < num_ch; ch++)
+            {
+                float v = column(ch)[slot];
+                if (!isnan(v))
+                {
+                    extend(2 * ch, slot, v, false);
+                    extend(2 * ch + 1, slot, v, true);
+                }
+            }
+        }
+    }
     else
     {
-        data[ofst] = ImVec2(x, y);
-        ofst = (ofst + 1) % max_sz;
+        // Each row is popped at most once, so this is O(1) per row pushed.
+        for (int dq = 0; dq < 2 * num_ch; dq++)
+        {
+            while (dq_len[dq] > 0 && seconds(dq_slots[dq * cap + dq_head[dq]]) < start)
+            {
+                dq_head[dq] = (dq_head[dq] + 1) % cap;
+                dq_len[dq]--;
+            }
+        }
+    }
+    dq_start = start;
+}
+
+float TelemetryStore::front(int dq)
+{
+    if (dq_len[dq] == 0)
+        return 0;
+    return column(dq / 2)[dq_slots[dq * cap + dq_head[dq]]];
+}
+
+void TelemetryStore::push(uint64_t mono, uint64_t utc, const float *values)
+{
+    advance();
+
+    t_mono[head] = mono;
+    t_utc[head] = utc;
+    for (int ch = 0; ch < num_ch; ch++)
+    {
+        cols[ch * cap + head] = values[ch];
+        if (!isnan(values[ch]))
+        {
+            extend(2 * ch, head, values[ch], false);
+            extend(2 * ch + 1, head, values[ch], true);
+        }
+    }
+
+    head = (head + 1) % cap;
+    if (count < cap)
+        count++;
+
+    for (int i = 0; i < TELEM_TIERS; i++)
+        fold(&tiers[i], utc, values);
+}
+
+void TelemetryStore::pushBreak(uint64_t mono, uint64_t utc)
+{
+    advance();
+
+    t_mono[head] = mono;
+    t_utc[head] = utc;
+    for (int ch = 0; ch < num_ch; ch++)
+        cols[ch * cap + head] = NAN;
+
+    head = (head + 1) % cap;
+    if (count < cap)
+        count++;
+}
+
+void TelemetryStore::clear()
+{
+    count = 0;
+    head = 0;
+    for (int dq = 0; dq < 2 * num_ch; dq++)
+    {
+        dq_head[dq] = 0;
+        dq_len[dq] = 0;
+    }
+    dq_start = -INFINITY;
+    for (int i = 0; i < TELEM_TIERS; i++)
+    {
+        tiers[i].head = 0;
+        tiers[i].count = 0;
+        tiers[i].cur = 0;
+    }
+}
+
+// Starts a bucket; a NULL row leaves every channel empty.
+void TelemetryStore::open(telem_tier_t *tr, uint64_t bucket, const float *values)
+{
+    int slot = tr->head;
+    tr->t_utc[slot] = bucket * tr->interval;
+    for (int ch = 0; ch < num_ch; ch++)
+    {
+        int i = ch * TELEM_TIER_LEN + slot;
+        float v = values != NULL ? values[ch] : NAN;
+        tr->min[i] = v;
+        tr->max[i] = v;
+        tr->mean[i] = v;
+        tr->n[i] = isnan(v) ? 0 : 1;
+    }
+
+    tr->cur = bucket;
+    tr->head = (tr->head + 1) % TELEM_TIER_LEN;
+    if (tr->count < TELEM_TIER_LEN)
+        tr->count++;
+}
+
+void TelemetryStore::fold(telem_tier_t *tr, uint64_t utc, const float *values)
+{
+    uint64_t bucket = utc / tr->interval;
+
+    // After the wall clock steps back, rows keep folding into the newest bucket until it catches up, so buckets stay in time order.
+    if (tr->count > 0 && bucket < tr->cur)
+        bucket = tr->cur;
+
+    if (tr->count == 0 || bucket != tr->cur)
+    {
+        // Whole intervals without data get one empty bucket, which breaks the plotted line.
+        if (tr->count > 0 && bucket > tr->cur + 1)
+            open(tr, tr->cur + 1, NULL);
+        open(tr, bucket, values);
+        return;
+    }
+
+    int slot = (tr->head - 1 + TELEM_TIER_LEN) % TELEM_TIER_LEN;
+    for (int ch = 0; ch < num_ch; ch++)
+    {
+        float v = values[ch];
+        if (isnan(v))
+            continue;
+
+        int i = ch * TELEM_TIER_LEN + slot;
+        if (tr->n[i] == 0)
+        {
+            tr->min[i] = v;
+            tr->max[i] = v;
+            tr->mean[i] = v;
+        }
+        else
+        {
+            if (v < tr->min[i])
+                tr->min[i] = v;
+            if (v > tr->max[i])
+                tr->max[i] = v;
+            tr->mean[i] += (v - tr->mean[i]) / (tr->n[i] + 1);
+        }
+        tr->n[i]++;
+    }
+}
+
+int TelemetryStore::pickTier(double start, double end)
+{
+    // Raw rows suffice while the oldest one still reaches back to the left edge, or nothing older was ever dropped.
+    if (count < cap || t_utc[head] / 1e9 <= start)
+        return -1;
+
+    for (int i = 0; i < TELEM_TIERS; i++)
+    {
+        if ((end - start) * 1e9 / tiers[i].interval <= TELEM_TIER_LEN)
+            return i;
+    }
+    return TELEM_TIERS - 1;
+}
+
+const telem_tier_t *TelemetryStore::tier(int idx)
+{
+    return &tiers[idx];
+}
+
+double TelemetryStore::tierSeconds(int idx, int slot)
+{
+    const telem_tier_t *tr = &tiers[idx];
+    return (tr->t_utc[slot] + tr->interval / 2) / 1e9;
+}
+
+void TelemetryStore::range(int ch, double start, double end, float *lo, float *hi)
+{
+    window(start);
+
+    int newest = (head - 1 + cap) % cap;
+    if (count == 0 || seconds(newest) <= end)
+    {
+        *lo = min(ch);
+        *hi = max(ch);
+        return;
     }
+
+    const float *col = column(ch);
+    float min = NAN;
+    float max = NAN;
+
+    // At most cap rows, whatever the span.
+    for (int slot = 0; slot < count; slot++)
+    {
+        double t = seconds(slot);
+        float v = col[slot];
+        if (t < start || t > end || isnan(v))
+            continue;
+        if (isnan(min) || v < min)
+            min = v;
+        if (isnan(max) || v > max)
+            max = v;
+    }
+
+    *lo = isnan(min) ? 0 : min;
+    *hi = isnan(max) ? 0 : max;
 }
 
-void ScrollBuf::Erase()
+void TelemetryStore::tierRange(int idx, int ch, double start, double end, float *lo, float *hi)
 {
-    if (data.size() > 0)
+    const telem_tier_t *tr = &tiers[idx];
+    float min = NAN;
+    float max = NAN;
+
+    // At most TELEM_TIER_LEN buckets, whatever the span.
+    for (int slot = 0; slot < tr->count; slot++)
     {
-        data.shrink(0);
-        ofst = 0;
+        double t0 = tr->t_utc[slot] / 1e9;
+        double t1 = t0 + tr->interval / 1e9;
+        int i = ch * TELEM_TIER_LEN + slot;
+        if (t1 < start || t0 > end || tr->n[i] == 0)
+            continue;
+        if (isnan(min) || tr->min[i] < min)
+            min = tr->min[i];
+        if (isnan(max) || tr->max[i] > max)
+            max = tr->max[i];
     }
+
+    *lo = isnan(min) ? 0 : min;
+    *hi = isnan(max) ? 0 : max;
+}
+
+int TelemetryStore::size()
+{
+    return count;
+}
+
+int TelemetryStore::offset()
+{
+    return count < cap ? 0 : head;
+}
+
+int TelemetryStore::capacity()
+{
+    return cap;
+}
+
+int TelemetryStore::channels()
+{
+    return num_ch;
+}
+
+const uint64_t *TelemetryStore::monoTimes()
+{
+    return t_mono;
+}
+
+const uint64_t *TelemetryStore::utcTimes()
+{
+    return t_utc;
 }
 
-float ScrollBuf::Max()
+double TelemetryStore::seconds(int slot)
 {
-    float max = data[0].y;
-    for (int i = 0; i < data.size(); i++)
-        if (data[i].y > max)
-            max = data[i].y;
-    return max;
+    return t_utc[slot] / 1e9;
 }
 
-float ScrollBuf::Min()
+const float *TelemetryStore::column(int ch)
 {
-    float min = data[0].y;
-    for (int i = 0; i < data.size(); i++)
-        if (data[i].y < min)
-            min = data[i].y;
-    return min;
+    return &cols[ch * cap];
 }
 
-ACSRollingBuffer::ACSRollingBuffer()
+float TelemetryStore::max(int ch)
 {
-    x_index = 0;
+    return front(2 * ch + 1);
+}
+
+float TelemetryStore::min(int ch)
+{
+    return front(2 * ch);
+}
+
+void acs_upd_decode(const acs_upd_output_t *pkts, int n, float *const *cols)
+{
+    const int num_half = ACS_CH_SZ - ACS_CH_BX + 1;
+    uint16_t half[num_half][ACS_DECODE_BLOCK];
+
+    for (int base = 0; base < n; base += ACS_DECODE_BLOCK)
+    {
+        int count = n - base < ACS_DECODE_BLOCK ? n - base : ACS_DECODE_BLOCK;
 
-    acs_upd_output_t dummy[1];
-    memset(dummy, 0x0, sizeof(acs_upd_output_t));
+        for (int i = 0; i < count; i++)
+        {
+            const acs_upd_output_t *pkt = &pkts[base + i];
 
-    // Avoids a crash.
-    addValueSet(*dummy);
+            // bx..sz are contiguous; copied out since the struct is packed.
+            uint16_t row[num_half];
+            memcpy(row, (const uint8_t *)pkt + offsetof(acs_upd_output_t, bx), sizeof(row));
+            for (int f = 0; f < num_half; f++)
+                half[f][i] = row[f];
 
-    pthread_mutex_init(&acs_upd_inhibitor, NULL);
+            cols[ACS_CH_CT][base + i] = pkt->ct;
+            cols[ACS_CH_MODE][base + i] = pkt->mode;
+            cols[ACS_CH_VBATT][base + i] = pkt->vbatt;
+            cols[ACS_CH_VBOOST][base + i] = pkt->vboost;
+            cols[ACS_CH_CURSUN][base + i] = pkt->cursun;
+            cols[ACS_CH_CURSYS][base + i] = pkt->cursys;
+        }
+
+        for (int f = 0; f < num_half; f++)
+            half_to_float_n(half[f], cols[ACS_CH_BX + f] + base, count);
+    }
+}
+
+ACSRollingBuffer::ACSRollingBuffer() : store(ACS_CH_NUM, MAX_ROLLBUF_LEN)
+{
+    owner = pthread_self();
+    foreign_writes = 0;
+    have_ct = false;
+    last_mono = 0;
+    last_utc = 0;
+    resetStats();
 }
 
-void ACSRollingBuffer::addValueSet(acs_upd_output_t data)
+void ACSRollingBuffer::addValueSet(acs_upd_output_t data, uint64_t t_mono, uint64_t t_utc)
 {
-    ct.AddPoint(x_index, data.ct);
-    mode.AddPoint(x_index, data.mode);
-    bx.AddPoint(x_index, data.bx);
-    by.AddPoint(x_index, data.by);
-    bz.AddPoint(x_index, data.bz);
-    wx.AddPoint(x_index, data.wx);
-    wy.AddPoint(x_index, data.wy);
-    wz.AddPoint(x_index, data.wz);
-    sx.AddPoint(x_index, data.sx);
-    sy.AddPoint(x_index, data.sy);
-    sz.AddPoint(x_index, data.sz);
-    vbatt.AddPoint(x_index, data.vbatt);
-    vboost.AddPoint(x_index, data.vboost);
-    cursun.AddPoint(x_index, data.cursun);
-    cursys.AddPoint(x_index, data.cursys);
+    if (!pthread_equal(owner, pthread_self()))
+    {
+        // The plots read without locking; a write from here could tear a row under them.
+        if (foreign_writes++ == 0)
+        {
+            dbprintlf_err(LOG_MOD_GEN, RED_FG "ACS update added from outside the GUI thread; refusing. Post it through the RX queue instead.");
+        }
+        return;
+    }
+
+    if (have_ct)
+    {
+        uint8_t step = data.ct - last_ct; // Modulo 256.
 
-    x_index += 0.1;
+        if (step == 0)
+        {
+            duplicates++;
+            return;
+        }
+
+        if (step > 1)
+        {
+            acs_gap_t *entry = &gap_history[gap_head];
+            gap_head = (gap_head + 1) % ACS_GAP_HISTORY;
+            if (num_gaps < ACS_GAP_HISTORY)
+            {
+                num_gaps++;
+            }
+
+            entry->t_utc = t_utc;
+            entry->span = (t_mono - last_mono) / 1e9;
+            entry->ct_from = last_ct;
+            entry->ct_to = data.ct;
+
+            if (step > 128)
+            {
+                // Backwards; the counter restarted rather than skipped ahead.
+                entry->missing = 0;
+                restarts++;
+            }
+            else
+            {
+                entry->missing = step - 1;
+                missing += step - 1;
+                gaps++;
+                if (step - 1 > longest_gap)
+                {
+                    longest_gap = step - 1;
+                }
+            }
+
+            // Halfway between the samples either side; the wall clock may have been stepped in between, so the difference is signed.
+            store.pushBreak(last_mono + (t_mono - last_mono) / 2, last_utc + (int64_t)(t_utc - last_utc) / 2);
+        }
+    }
+    have_ct = true;
+    last_ct = data.ct;
+    last_mono = t_mono;
+    last_utc = t_utc;
+    samples++;
+
+    float values[ACS_CH_NUM];
+    float *cols[ACS_CH_NUM];
+    for (int ch = 0; ch < ACS_CH_NUM; ch++)
+        cols[ch] = &values[ch];
+    acs_upd_decode(&data, 1, cols);
+    store.push(t_mono, t_utc, values);
+}
+
+void ACSRollingBuffer::resetStats()
+{
+    samples = 0;
+    missing = 0;
+    gaps = 0;
+    duplicates = 0;
+    restarts = 0;
+    longest_gap = 0;
+    gap_head = 0;
+    num_gaps = 0;
+}
+
+int ACSRollingBuffer::gapCount()
+{
+    return num_gaps;
+}
+
+const acs_gap_t *ACSRollingBuffer::gap(int idx)
+{
+    if (idx < 0 || idx >= num_gaps)
+    {
+        return NULL;
+    }
+    return &gap_history[(gap_head - 1 - idx + ACS_GAP_HISTORY) % ACS_GAP_HISTORY];
 }
 
 ACSRollingBuffer::~ACSRollingBuffer()
 {
-    pthread_mutex_destroy(&acs_upd_inhibitor);
 }
\ No newline at end of file
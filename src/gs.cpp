@@ -18,10 +18,19 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <ifaddrs.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include "gs.hpp"
 #include "meb_debug.hpp"
 #include "sw_update_packdef.h"
 #include "phy.hpp"
+#include "gs_rx.hpp"
+#include "gs_log.hpp"
 
 void glfw_error_callback(int error, const char *description)
 {
@@ -281,30 +290,336 @@ int gs_helper(void *aa)
     return ~e;
 }
 
-void *gs_acs_update_thread(void *global_data_vp)
+AcsPoller::AcsPoller(TxEngine *tx) : polls(0), too_soon(0), overruns(0), answered(0), lost(0), backoffs(0), out_head(0), out_count(0), responses_seen(0), win_head(0), win_count(0), t_adjust(0), tx(tx), period_ms(ACS_POLL_PERIOD_MIN), adaptive_on(true), responses(0), win_lost(0), win_total(0), t_last(0), running(false), thread_started(false)
 {
-    global_data_t *global = (global_data_t *)global_data_vp;
+    timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (timerfd < 0 || wakefd < 0)
+    {
+        dbprintlf_err(LOG_MOD_GEN, FATAL "Failed to create ACS poller timers.");
+        erprintlf(errno);
+    }
+}
 
-    cmd_input_t acs_cmd[1];
-    memset(acs_cmd, 0x0, sizeof(cmd_input_t));
+AcsPoller::~AcsPoller()
+{
+    stop();
+    if (timerfd >= 0)
+    {
+        close(timerfd);
+    }
+    if (wakefd >= 0)
+    {
+        close(wakefd);
+    }
+}
 
-    acs_cmd->mod = ACS_UPD_ID;
-    acs_cmd->unused = 0x0;
-    acs_cmd->data_size = 0x0;
-    memset(acs_cmd->data, 0x0, MAX_DATA_SIZE);
+static void *gs_acs_poller_thread(void *args)
+{
+    ((AcsPoller *)args)->run();
+    return NULL;
+}
+
+int AcsPoller::start()
+{
+    if (thread_started)
+    {
+        if (running)
+        {
+            return 1;
+        }
+        // The thread gave up on its own; reap it before starting another.
+        pthread_join(thread, NULL);
+        thread_started = false;
+    }
+
+    uint64_t count;
+    while (read(wakefd, &count, sizeof(count)) > 0)
+        ;
+
+    // Updates that arrive from here on answer this run's requests.
+    out_head = 0;
+    out_count = 0;
+    responses_seen = responses;
+    win_count = 0;
+    win_lost = 0;
+    win_total = 0;
+
+    running = true;
+    if (pthread_create(&thread, NULL, gs_acs_poller_thread, this) != 0)
+    {
+        running = false;
+        dbprintlf_err(LOG_MOD_GEN, RED_FG "Failed to start ACS poller thread.");
+        return -1;
+    }
+    thread_started = true;
+
+    return 1;
+}
+
+void AcsPoller::stop()
+{
+    if (!thread_started)
+    {
+        return;
+    }
+
+    running = false;
+    uint64_t one = 1;
+    if (write(wakefd, &one, sizeof(one)) != sizeof(one))
+    {
+        // Counter saturated; a wakeup is already pending.
+    }
+    pthread_join(thread, NULL);
+    thread_started = false;
+}
+
+bool AcsPoller::active()
+{
+    return running;
+}
+
+void AcsPoller::set_period(int ms)
+{
+    adaptive_on = false;
+    period_ms = ms < ACS_POLL_PERIOD_MIN ? ACS_POLL_PERIOD_MIN : ms;
+}
+
+int AcsPoller::period()
+{
+    return period_ms;
+}
+
+void AcsPoller::set_adaptive(bool on)
+{
+    adaptive_on = on;
+}
+
+bool AcsPoller::adaptive()
+{
+    return adaptive_on;
+}
+
+void AcsPoller::received()
+{
+    responses++;
+}
+
+double AcsPoller::loss()
+{
+    int total = win_total;
+    return total > 0 ? (double)win_lost / total : 0;
+}
+
+void AcsPoller::outcome(bool ok, uint64_t t_sent)
+{
+    if (ok)
+    {
+        answered++;
+    }
+    else
+    {
+        lost++;
+    }
+
+    if (t_sent < t_adjust)
+    {
+        return;
+    }
+
+    if (win_count == ACS_LOSS_WINDOW)
+    {
+        // Slide the oldest outcome out.
+        if (!window[win_head])
+        {
+            win_lost--;
+        }
+    }
+    else
+    {
+        win_count++;
+    }
+
+    window[win_head] = ok;
+    win_head = (win_head + 1) % ACS_LOSS_WINDOW;
+    if (!ok)
+    {
+        win_lost++;
+    }
+    win_total = win_count;
+}
+
+void AcsPoller::account(uint64_t now)
+{
+    // Each update answers the oldest request still outstanding; extras arrived after their request was written off.
+    uint64_t seen = responses;
+    uint64_t fresh = seen - responses_seen;
+    responses_seen = seen;
+    for (; fresh > 0 && out_count > 0; fresh--)
+    {
+        outcome(true, outstanding[out_head]);
+        out_head = (out_head + 1) % ACS_POLL_OUTSTANDING;
+        out_count--;
+    }
+
+    uint64_t timeout_ns = (uint64_t)ACS_POLL_TIMEOUT * 1000000ULL;
+    while (out_count > 0 && now - outstanding[out_head] >= timeout_ns)
+    {
+        outcome(false, outstanding[out_head]);
+        out_head = (out_head + 1) % ACS_POLL_OUTSTANDING;
+        out_count--;
+    }
+}
+
+void AcsPoller::adapt(uint64_t now)
+{
+    // Each rate is judged only on the requests sent at it.
+    if (win_count < ACS_LOSS_WINDOW)
+    {
+        return;
+    }
+
+    double rate = 1000.0 / period_ms;
+    double frac = loss();
+    if (frac > ACS_LOSS_HIGH)
+    {
+        rate /= 2;
+        backoffs++;
+    }
+    else if (frac <= ACS_LOSS_LOW)
+    {
+        rate += ACS_RATE_STEP;
+    }
+    else
+    {
+        return;
+    }
 
-    // Transmit an ACS update request to the server.
+    int ms = (int)(1000.0 / rate + 0.5);
+    if (ms < ACS_POLL_PERIOD_MIN)
+    {
+        ms = ACS_POLL_PERIOD_MIN;
+    }
+    else if (ms > ACS_POLL_PERIOD_SLOW)
+    {
+        ms = ACS_POLL_PERIOD_SLOW;
+    }
+
+    if (ms != period_ms)
+    {
+        dbprintlf_dbg(LOG_MOD_GEN, "ACS poll period %d ms -> %d ms at %.0f%% loss.", period_ms.load(), ms, frac * 100);
+        period_ms = ms;
+        win_count = 0;
+        win_lost = 0;
+        win_total = 0;
+        t_adjust = now;
+    }
+}
+
+int AcsPoller::send(uint64_t at)
+{
+    // Claim the slot first, so a one-shot request and a periodic one racing each other cannot both go out within ACS_POLL_PERIOD_MIN.
+    uint64_t last = t_last.load();
+    do
+    {
+        if (last != 0 && (int64_t)(at - last) < (int64_t)ACS_POLL_PERIOD_MIN * 1000000LL)
+        {
+            too_soon++;
+            return 0;
+        }
+    } while (!t_last.compare_exchange_weak(last, at));
+
+    // Built directly in its queue slot.
     // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, acs_cmd, sizeof(cmd_input_t));
-    NetFrame *network_frame = new NetFrame((unsigned char *)acs_cmd, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-    network_frame->sendFrame(global->network_data);
-    delete network_frame;
+    cmd_input_t *acs_cmd = tx->reserve<cmd_input_t>(TX_ORIGIN_ACS_UPD);
+    if (acs_cmd == NULL)
+    { // Nothing went out; give the slot back unless another request has claimed a later one since.
+        t_last.compare_exchange_strong(at, last);
+        return -1;
+    }
+    acs_cmd->mod = ACS_UPD_ID;
 
-    // !WARN! Any faster than 0.5 seconds seems to break the Network.
-    usleep(ACS_UPDATE_FREQUENCY SEC);
+    polls++;
+    return tx->commit(acs_cmd, NetType::DATA, NetVertex::ROOFUHF);
+}
+
+int AcsPoller::poll_once()
+{
+    // A one-shot request while polling would be counted against the poller's requests and understate loss.
+    if (running)
+    {
+        too_soon++;
+        return 0;
+    }
+    return send(lat_now_ns());
+}
 
-    pthread_mutex_unlock(&global->acs_rolbuf->acs_upd_inhibitor);
+void AcsPoller::run()
+{
+    uint64_t deadline = lat_now_ns();
 
-    return NULL;
+    while (running)
+    {
+        uint64_t now = lat_now_ns();
+        late.record(now - deadline);
+
+        account(now);
+        if (adaptive_on)
+        {
+            adapt(now);
+        }
+
+        // Stamped with the deadline rather than the wakeup, so lateness on one pass does not make the next, on-time request look too soon.
+        if (send(deadline) > 0)
+        {
+            if (out_count == ACS_POLL_OUTSTANDING)
+            {
+                outcome(false, outstanding[out_head]);
+                out_head = (out_head + 1) % ACS_POLL_OUTSTANDING;
+                out_count--;
+            }
+            outstanding[(out_head + out_count) % ACS_POLL_OUTSTANDING] = now;
+            out_count++;
+        }
+
+        uint64_t period_ns = (uint64_t)period_ms.load() * 1000000ULL;
+        deadline += period_ns;
+        if (deadline <= now)
+        {
+            uint64_t missed = (now - deadline) / period_ns + 1;
+            overruns += missed;
+            deadline += missed * period_ns;
+        }
+
+        struct itimerspec its;
+        memset(&its, 0x0, sizeof(its));
+        its.it_value.tv_sec = deadline / 1000000000ULL;
+        its.it_value.tv_nsec = deadline % 1000000000ULL;
+        timerfd_settime(timerfd, TFD_TIMER_ABSTIME, &its, NULL);
+
+        struct pollfd pfd[2];
+        pfd[0].fd = timerfd;
+        pfd[0].events = POLLIN;
+        pfd[1].fd = wakefd;
+        pfd[1].events = POLLIN;
+
+        // Retry interrupted waits; the timer stays armed for the same absolute deadline.
+        int retval;
+        while ((retval = poll(pfd, 2, -1)) < 0 && errno == EINTR)
+            ;
+        if (retval < 0 || (pfd[1].revents & POLLIN))
+        {
+            break;
+        }
+
+        uint64_t expirations;
+        if (read(timerfd, &expirations, sizeof(expirations)) < 0)
+        {
+            // Nothing to consume; the deadline is re-checked against the clock on the next pass.
+        }
+    }
+
+    running = false;
 }
 
 // int gs_transmit(NetworkData *network_data, NETWORK_FRAME_TYPE type, NETWORK_FRAME_ENDPOINT endpoint, void *data, int data_size)
@@ -349,6 +664,332 @@ void *gs_acs_update_thread(void *global_data_vp)
 //     return NULL;
 // }
 
+/**
+ * @brief Limits a received payload size to the size of the structure it is copied into.
+ *
+ */
+static inline size_t gs_rx_clamp(int payload_size, size_t capacity)
+{
+    if (payload_size < 0)
+    {
+        return 0;
+    }
+    return (size_t)payload_size < capacity ? (size_t)payload_size : capacity;
+}
+
+RxMsgQueue::RxMsgQueue() : closed(false)
+{
+    for (int i = 0; i < RX_CLASS_NUM; i++)
+    {
+        queued[i] = 0;
+        dropped[i] = 0;
+        blocked[i] = 0;
+        high_water[i] = 0;
+    }
+    policy[RX_CLASS_CONTROL] = RX_POLICY_BLOCK;
+    policy[RX_CLASS_TELEMETRY] = RX_POLICY_DROP_OLDEST;
+}
+
+int RxMsgQueue::classify(int kind)
+{
+    return kind == RX_MSG_ACS_UPD ? RX_CLASS_TELEMETRY : RX_CLASS_CONTROL;
+}
+
+const char *RxMsgQueue::class_name(int cls)
+{
+    switch (cls)
+    {
+    case RX_CLASS_CONTROL:
+        return "Control";
+    case RX_CLASS_TELEMETRY:
+        return "Telemetry";
+    default:
+        return "Unknown";
+    }
+}
+
+const char *RxMsgQueue::policy_name(int policy)
+{
+    switch (policy)
+    {
+    case RX_POLICY_DROP_OLDEST:
+        return "Drop Oldest";
+    case RX_POLICY_DROP_NEWEST:
+        return "Drop Newest";
+    case RX_POLICY_BLOCK:
+        return "Never Drop";
+    default:
+        return "Unknown";
+    }
+}
+
+void RxMsgQueue::close()
+{
+    closed = true;
+}
+
+int RxMsgQueue::push(const rx_msg_t *msg)
+{
+    int cls = classify(msg->kind);
+    int retval = 1;
+
+    switch (policy[cls].load(std::memory_order_relaxed))
+    {
+    case RX_POLICY_DROP_OLDEST:
+    {
+        if (ring[cls].push_evict(*msg))
+        {
+            dropped[cls]++;
+            retval = 0;
+        }
+        break;
+    }
+    case RX_POLICY_DROP_NEWEST:
+    {
+        if (!ring[cls].push(*msg))
+        {
+            dropped[cls]++;
+            return -1;
+        }
+        break;
+    }
+    case RX_POLICY_BLOCK:
+    default:
+    {
+        if (!ring[cls].push(*msg))
+        {
+            blocked[cls]++;
+            int backoff = RX_BLOCK_BACKOFF_MIN;
+            do
+            {
+                if (closed)
+                {
+                    dropped[cls]++;
+                    return -1;
+                }
+                usleep(backoff);
+                backoff = backoff * 2 < RX_BLOCK_BACKOFF_MAX ? backoff * 2 : RX_BLOCK_BACKOFF_MAX;
+            } while (!ring[cls].push(*msg));
+        }
+        break;
+    }
+    }
+
+    queued[cls]++;
+    uint64_t depth = ring[cls].size();
+    if (depth > high_water[cls].load(std::memory_order_relaxed))
+    {
+        high_water[cls] = depth;
+    }
+
+    return retval;
+}
+
+bool RxMsgQueue::pop(rx_msg_t *msg)
+{
+    for (int i = 0; i < RX_CLASS_NUM; i++)
+    {
+        if (ring[i].pop(msg))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t RxMsgQueue::size(int cls)
+{
+    return ring[cls].size();
+}
+
+size_t RxMsgQueue::capacity()
+{
+    return RX_QUEUE_LEN;
+}
+
+/**
+ * @brief Hands a decoded message to the GUI thread according to its class's overload policy.
+ * 
+ */
+static inline void gs_rx_post(global_data_t *global_data, rx_msg_t *msg)
+{
+    msg->t_ready = global_data->rx_latency->cur_ready;
+    msg->t_handled = lat_now_ns();
+    // Back-dated to when the socket became readable, rather than read again at every readiness.
+    msg->t_utc = lat_utc_ns() - (msg->t_handled - msg->t_ready);
+
+    global_data->rx_queue->push(msg);
+}
+
+int gs_rx_drain(global_data_t *global)
+{
+    rx_msg_t msg;
+    int count = 0;
+
+    while (global->rx_queue->pop(&msg))
+    {
+        global->rx_latency->drained(msg.t_ready, msg.t_handled);
+
+        switch (msg.kind)
+        {
+        case RX_MSG_ACK:
+        case RX_MSG_NACK:
+        {
+            memcpy(global->cs_ack, &msg.ack, sizeof(cs_ack_t));
+            break;
+        }
+        case RX_MSG_XBAND_CONFIG:
+        {
+            memcpy(global->cs_config_xband, &msg.xband_config, sizeof(xband_set_data_t));
+            break;
+        }
+        case RX_MSG_CMD_OUTPUT:
+        {
+            const cmd_output_t *output = &msg.cmd_output;
+            global->cmd_tracker->reply(output->mod, output->cmd, output->retval, output->data, output->data_size, msg.t_ready);
+            break;
+        }
+        case RX_MSG_ACS_UPD:
+        {
+            global->acs_rolbuf->addValueSet(msg.acs_upd, msg.t_ready, msg.t_utc);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+        }
+        count++;
+    }
+
+    return count;
+}
+
+static void gs_rx_handle_poll(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{ // Will have status data.
+    lgprintlf_dbg(LOG_MOD_RX, "Received NULL frame.");
+}
+
+static void gs_rx_handle_ack(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{
+    global_data_t *global_data = (global_data_t *)ctx;
+
+    lgprintlf_dbg(LOG_MOD_RX, "Received ACK.");
+
+    rx_msg_t msg;
+    memset(&msg, 0x0, sizeof(rx_msg_t));
+    msg.kind = RX_MSG_ACK;
+    memcpy(&msg.ack, payload.data, gs_rx_clamp(payload.size, sizeof(cs_ack_t)));
+    gs_rx_post(global_data, &msg);
+}
+
+static void gs_rx_handle_nack(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{
+    global_data_t *global_data = (global_data_t *)ctx;
+
+    lgprintlf_dbg(LOG_MOD_RX, "Received N/ACK.");
+
+    rx_msg_t msg;
+    memset(&msg, 0x0, sizeof(rx_msg_t));
+    msg.kind = RX_MSG_NACK;
+    memcpy(&msg.ack, payload.data, gs_rx_clamp(payload.size, sizeof(cs_ack_t)));
+    gs_rx_post(global_data, &msg);
+
+    if (payload.size >= (int)sizeof(cs_ack_t) && msg.ack.code == NACK_NO_UHF)
+    {
+        // Immediately cancel all ongoing software updates, since the Roof UHF is complaining that it cannot use the UHF.
+        lgprintlf_err(LOG_MOD_RX, RED_FG "Roof UHF responded saying that it cannot access UHF communications at this time. Halting all software updates.");
+        global_data->sw_updating = false;
+    }
+}
+
+static void gs_rx_handle_uhf_config(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{
+    // NOTE: No UHF configurations exist at this time, so there is nothing to hand to the GUI.
+    lgprintlf_dbg(LOG_MOD_RX, "Received UHF Config.");
+}
+
+static void gs_rx_handle_xband_config(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{
+    global_data_t *global_data = (global_data_t *)ctx;
+
+    lgprintlf_dbg(LOG_MOD_RX, "Received X-Band Config.");
+
+    rx_msg_t msg;
+    memset(&msg, 0x0, sizeof(rx_msg_t));
+    msg.kind = RX_MSG_XBAND_CONFIG;
+    memcpy(&msg.xband_config, payload.data, gs_rx_clamp(payload.size, sizeof(xband_set_data_t)));
+    gs_rx_post(global_data, &msg);
+}
+
+// ASSERTION: All 'DATA'-type frame payloads incoming to the client is in the form of a from-SPACE-HAUC cmd_output_t.
+
+static void gs_rx_handle_sw_upd(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{
+    global_data_t *global_data = (global_data_t *)ctx;
+
+    // If we can't get the lock, only wait for one second.
+    struct timespec timeout;
+    clock_gettime(CLOCK_REALTIME, &timeout);
+    timeout.tv_sec += 1;
+
+    if (pthread_mutex_timedlock(global_data->sw_output_lock, &timeout) == 0)
+    {
+        memcpy(global_data->sw_output, payload.data, gs_rx_clamp(payload.size, sizeof(cmd_output_t)));
+        global_data->sw_output_fresh = true;
+        pthread_mutex_unlock(global_data->sw_output_lock);
+    }
+    else
+    {
+        lgprintlf_err(LOG_MOD_RX, RED_FG "Failed to acquire sw_data_lock.");
+    }
+}
+
+static void gs_rx_handle_acs_upd(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{
+    global_data_t *global_data = (global_data_t *)ctx;
+    const cmd_output_t *output = (const cmd_output_t *)payload.data;
+
+    // The ACS update travels in the data field of the cmd_output_t (see acs_upd_output_t).
+    if (payload.size < (int)(offsetof(cmd_output_t, data) + sizeof(acs_upd_output_t)))
+    {
+        lgprintlf_err(LOG_MOD_RX, RED_FG "ACS update too short (%d bytes).", payload.size);
+        return;
+    }
+
+    global_data->acs_poller->received();
+
+    rx_msg_t msg;
+    msg.kind = RX_MSG_ACS_UPD;
+    memcpy(&msg.acs_upd, output->data, sizeof(acs_upd_output_t));
+    gs_rx_post(global_data, &msg);
+}
+
+static void gs_rx_handle_cmd_output(void *ctx, const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{
+    global_data_t *global_data = (global_data_t *)ctx;
+
+    rx_msg_t msg;
+    memset(&msg, 0x0, sizeof(rx_msg_t));
+    msg.kind = RX_MSG_CMD_OUTPUT;
+    memcpy(&msg.cmd_output, payload.data, gs_rx_clamp(payload.size, sizeof(cmd_output_t)));
+    gs_rx_post(global_data, &msg);
+}
+
+void gs_rx_register_handlers(global_data_t *global)
+{
+    RxDispatcher *dispatcher = global->rx_dispatcher;
+
+    dispatcher->register_handler("POLL", NetType::POLL, RX_ANY, RX_ANY, gs_rx_handle_poll, global);
+    dispatcher->register_handler("ACK", NetType::ACK, RX_ANY, RX_ANY, gs_rx_handle_ack, global);
+    dispatcher->register_handler("NACK", NetType::NACK, RX_ANY, RX_ANY, gs_rx_handle_nack, global);
+    dispatcher->register_handler("UHF_CONFIG", NetType::UHF_CONFIG, RX_ANY, RX_ANY, gs_rx_handle_uhf_config, global);
+    dispatcher->register_handler("XBAND_CONFIG", NetType::XBAND_CONFIG, RX_ANY, RX_ANY, gs_rx_handle_xband_config, global);
+    dispatcher->register_handler("DATA/SW_UPD", NetType::DATA, SW_UPD_ID, RX_ANY, gs_rx_handle_sw_upd, global);
+    dispatcher->register_handler("DATA/ACS_UPD", NetType::DATA, ACS_UPD_ID, RX_ANY, gs_rx_handle_acs_upd, global);
+    dispatcher->register_handler("DATA", NetType::DATA, RX_ANY, RX_ANY, gs_rx_handle_cmd_output, global);
+}
+
 // Updated, referenced "void *rcv_thr(void *sock)" from line 338 of: https://github.com/sunipkmukherjee/comic-mon/blob/master/guimain.cpp
 // Also see: https://github.com/mitbailey/socket_server
 void *gs_rx_thread(void *args)
@@ -356,148 +997,223 @@ void *gs_rx_thread(void *args)
     // Convert the passed void pointer into something useful; in this case, global_data_t.
     global_data_t *global_data = (global_data_t *)args;
     NetDataClient *network_data = global_data->network_data;
+    RxEngine *engine = global_data->rx_engine;
+    RxStream *stream = global_data->rx_stream;
+    RxLatency *latency = global_data->rx_latency;
 
     while (network_data->recv_active && network_data->thread_status > 0)
     {
-        if (!network_data->connection_ready)
+        // Keep the epoll set in step with the connection state. Re-registering on every pass also catches a reconnect that reused the previous descriptor number.
+        if (network_data->connection_ready && network_data->socket >= 0)
         {
-            sleep(5);
-            continue;
+            if (engine->watched != network_data->socket)
+            {
+                stream->reset();
+                engine->watch(network_data->socket);
+                engine->arm_timeout(RECV_TIMEOUT);
+            }
+        }
+        else if (engine->watched >= 0)
+        {
+            engine->unwatch();
         }
 
-        int read_size = 0;
+        lgprintlf_trc(LOG_MOD_RX, BLUE_BG "Waiting to receive...");
+        int events = engine->wait(-1);
 
-        while (read_size >= 0 && network_data->recv_active && network_data->thread_status > 0)
+        if (events & RX_EV_ERROR)
         {
-            dbprintlf(BLUE_BG "Waiting to receive...");
+            erprintlf(errno);
+            usleep(0.1 SEC);
+            continue;
+        }
 
-            NetFrame *netframe = new NetFrame();
-            read_size = netframe->recvFrame(network_data);
+        if (events & RX_EV_WAKE)
+        { // Connection state changed or we are shutting down; drop the registration so it is re-evaluated above.
+            engine->unwatch();
+            continue;
+        }
 
-            dbprintlf("Read %d bytes.", read_size);
+        if (!network_data->connection_ready || engine->watched < 0)
+        {
+            continue;
+        }
 
-            if (read_size >= 0)
+        if (events & RX_EV_TIMEOUT)
+        {
+            lgprintlf_wrn(LOG_MOD_RX, YELLOW_BG "Active connection timed-out (%d s without data).", RECV_TIMEOUT);
+            strcpy(network_data->disconnect_reason, "TIMED-OUT");
+            network_data->connection_ready = false;
+            engine->unwatch();
+            continue;
+        }
+
+        if (events & RX_EV_READABLE)
+        {
+            // Drain the socket completely, parsing every complete frame after each read.
+            ssize_t read_size;
+            latency->cur_ready = lat_now_ns();
+            do
             {
-                dbprintlf("Received the following NetFrame:");
-                netframe->print();
-                netframe->printNetstat();
-
-                // Extract the payload into a buffer.
-                int payload_size = netframe->getPayloadSize();
-                unsigned char *payload = (unsigned char *)malloc(payload_size);
-                if (netframe->retrievePayload(payload, payload_size) < 0)
-                {
-                    dbprintlf("Error retrieving data.");
-                    continue;
-                }
+                read_size = stream->fill(network_data->socket);
 
-                // Based on what we got, set things to display the data.
-                switch (netframe->getType())
-                {
-                case NetType::POLL:
-                { // Will have status data.
-                    dbprintlf("Received NULL frame.");
-                    // global_data->netstat = clientserver_frame->getNetstat();
-                    break;
-                }
-                case NetType::ACK:
+                lgprintlf_trc(LOG_MOD_RX, "Read %d bytes.", (int)read_size);
+
+                if (read_size > 0)
                 {
-                    dbprintlf("Received ACK.");
-                    memcpy(global_data->cs_ack, payload, payload_size);
-                    break;
+                    engine->arm_timeout(RECV_TIMEOUT);
                 }
-                case NetType::NACK:
+
+                rx_frame_ref_t ref;
+                while (stream->next(&ref) > 0)
                 {
-                    dbprintlf("Received N/ACK.");
-                    memcpy(global_data->cs_ack, payload, payload_size);
+                    latency->cur_parsed = lat_now_ns();
+                    latency->stage[RX_LAT_PARSE].record(latency->cur_parsed - latency->cur_ready);
 
-                    if (((cs_ack_t *)payload)->code == NACK_NO_UHF)
-                    {
-                        // Immediately cancel all ongoing software updates, since the Roof UHF is complaining that it cannot use the UHF.
-                        dbprintlf(RED_FG "Roof UHF responded saying that it cannot access UHF communications at this time. Halting all software updates.");
-                        global_data->sw_updating = false;
-                    }
+                    lgprintlf_dbg(LOG_MOD_RX, "Received frame: type 0x%02x, origin 0x%02x, destination 0x%02x, payload %d bytes, netstat 0x%02x.", ref.hdr.type, ref.hdr.origin, ref.hdr.destination, ref.hdr.payload_size, ref.hdr.netstat);
+                    global_data->netstat = ref.hdr.netstat;
 
-                    break;
+                    global_data->rx_dispatcher->dispatch(&ref.hdr, ref.payload);
+                    latency->stage[RX_LAT_HANDLE].record(lat_now_ns() - latency->cur_parsed);
                 }
-                case NetType::UHF_CONFIG:
-                {
-                    dbprintlf("Received UHF Config.");
-                    memcpy(global_data->cs_config_uhf, payload, payload_size);
-                    break;
-                }
-                case NetType::XBAND_CONFIG:
+
+                // Anything read next was already waiting on the socket as of now.
+                latency->cur_ready = lat_now_ns();
+            } while (read_size > 0);
+
+            if (read_size == 0)
+            {
+                continue;
+            }
+            else if (read_size == -404)
+            {
+                lgprintlf_err(LOG_MOD_RX, RED_BG "Connection forcibly closed by the server.");
+                strcpy(network_data->disconnect_reason, "SERVER-FORCED");
+            }
+            else
+            {
+                erprintlf(errno);
+                strcpy(network_data->disconnect_reason, "RECV-ERROR");
+            }
+            network_data->connection_ready = false;
+            engine->unwatch();
+            continue;
+        }
+
+        if (events & RX_EV_HANGUP)
+        {
+            lgprintlf_err(LOG_MOD_RX, RED_BG "Connection forcibly closed by the server.");
+            strcpy(network_data->disconnect_reason, "SERVER-FORCED");
+            network_data->connection_ready = false;
+            engine->unwatch();
+        }
+    }
+
+    network_data->recv_active = false;
+    lgprintlf_err(LOG_MOD_RX, FATAL "DANGER! RECEIVE THREAD IS RETURNING!");
+    return NULL;
+}
+
+void *gs_tx_thread(void *args)
+{
+    global_data_t *global_data = (global_data_t *)args;
+    NetDataClient *network_data = global_data->network_data;
+    TxEngine *engine = global_data->tx_engine;
+
+    int nodelay_socket = -1;
+
+    while (engine->active)
+    {
+        tx_req_t *batch[TX_BATCH_MAX];
+        int flows[TX_BATCH_MAX];
+        int count;
+
+        // Take everything already queued (up to a batch, highest class first), but never wait for more: a lone command goes out at once.
+        while ((count = engine->schedule(batch, flows, TX_BATCH_MAX)) > 0)
+        {
+            if (!network_data->connection_ready || network_data->socket < 0)
+            {
+                lgprintlf_wrn(LOG_MOD_TX, YELLOW_FG "Not connected; dropping %d frame(s).", count);
+                for (int i = 0; i < count; i++)
                 {
-                    dbprintlf("Received X-Band Config.");
-                    memcpy(global_data->cs_config_xband, payload, payload_size);
-                    break;
+                    engine->complete(batch[i], TX_STATUS_NOT_CONNECTED, 0);
+                    engine->pop(flows[i]);
                 }
-                case NetType::DATA: // Data type is just cmd_output_t (SH->GS)
+                continue;
+            }
+
+            if (nodelay_socket != network_data->socket)
+            { // New connection; corking decides when segments go out, not Nagle.
+                int one = 1;
+                setsockopt(network_data->socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                nodelay_socket = network_data->socket;
+            }
+
+            int written = gs_tx_write_batch(network_data->socket, batch, count, &engine->writes);
+            int err = errno;
+
+            if (count > 1 && written > 1)
+            {
+                engine->coalesced += written;
+            }
+            if ((uint64_t)written > engine->max_batch.load(std::memory_order_relaxed))
+            {
+                engine->max_batch = written;
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+                if (i < written)
                 {
-                    // ASSERTION: All 'DATA'-type frame payloads incoming to the client is in the form of a from-SPACE-HAUC cmd_output_t.
-
-                    if (((cmd_output_t *)payload)->mod == SW_UPD_ID)
-                    { // If this is part of an sw_update...
-                        // If we can't get the lock, only wait for one second.
-                        struct timespec timeout;
-                        clock_gettime(CLOCK_REALTIME, &timeout);
-                        timeout.tv_sec += 1;
-
-                        if (pthread_mutex_timedlock(global_data->sw_output_lock, &timeout) == 0)
-                        {
-                            memcpy(global_data->sw_output, payload, payload_size);
-                            global_data->sw_output_fresh = true;
-                            pthread_mutex_unlock(global_data->sw_output_lock);
-                        }
-                        else
-                        {
-                            dbprintlf(RED_FG "Failed to acquire sw_data_lock.");
-                        }
-                    }
-                    else if (((cmd_output_t *)payload)->mod != ACS_UPD_ID)
-                    { // If this is not an ACS Update...
-                        memcpy(global_data->cmd_output, payload, payload_size);
-                    }
-                    else
-                    { // If it is an ACS update...
-                        global_data->acs_rolbuf->addValueSet(*((acs_upd_output_t *)payload));
-                    }
-                    break;
+                    lgprintlf_dbg(LOG_MOD_TX, "Sent %s frame #%u (%d bytes of payload).", TxEngine::origin_name(batch[i]->origin), batch[i]->tag, batch[i]->size);
+                    engine->complete(batch[i], TX_STATUS_SENT, 0);
                 }
-                default:
+                else
                 {
-                    break;
+                    lgprintlf_err(LOG_MOD_TX, RED_FG "Failed to send %s frame #%u (errno %d).", TxEngine::origin_name(batch[i]->origin), batch[i]->tag, err);
+                    engine->complete(batch[i], TX_STATUS_FAILED, err);
                 }
-                }
-                free(payload);
+                engine->pop(flows[i]);
             }
-            else
-            {
+
+            if (written < count)
+            { // The write may have stopped partway through a frame, after which nothing else sent on this connection would parse; drop it.
+                // Shut down, not closed: the RX thread may still be watching the descriptor, and only the GUI thread closes it, so its number cannot be reused underneath either.
+                lgprintlf_err(LOG_MOD_TX, RED_BG "Dropping the connection after a failed write (errno %d).", err);
+                shutdown(network_data->socket, SHUT_RDWR);
+                strcpy(network_data->disconnect_reason, "SEND-ERROR");
+                network_data->connection_ready = false;
+                global_data->rx_engine->wake();
                 break;
             }
+        }
+
+        // Sleep until more is queued, or until the UHF link budget lets a held frame go.
+        engine->wait(engine->throttle_wait_ms());
+    }
 
-            delete netframe;
+    return NULL;
+}
 
-        }
-        if (read_size == -404)
+void *gs_keepalive_thread(void *args)
+{
+    global_data_t *global_data = (global_data_t *)args;
+    NetDataClient *network_data = global_data->network_data;
+
+    while (network_data->recv_active)
+    {
+        if (network_data->connection_ready)
         {
-            dbprintlf(RED_BG "Connection forcibly closed by the server.");
-            strcpy(network_data->disconnect_reason, "SERVER-FORCED");
-            network_data->connection_ready = false;
-            continue;
+            global_data->tx_engine->submit(NULL, 0, NetType::POLL, NetVertex::SERVER, TX_ORIGIN_KEEPALIVE);
         }
-        else if (errno == EAGAIN)
+
+        // Short sleeps, so shutdown does not wait out a whole period.
+        for (int i = 0; i < SERVER_POLL_RATE * 10 && network_data->recv_active; i++)
         {
-            dbprintlf(YELLOW_BG "Active connection timed-out (%d).", read_size);
-            strcpy(network_data->disconnect_reason, "TIMED-OUT");
-            network_data->connection_ready = false;
-            continue;
+            usleep(100000);
         }
-        erprintlf(errno);
     }
 
-    network_data->recv_active = false;
-    dbprintlf(FATAL "DANGER! RECEIVE THREAD IS RETURNING!");
     return NULL;
 }
 
@@ -506,45 +1222,45 @@ void *gs_rx_thread(void *args)
 void *gs_sw_send_file_thread(void *args)
 {
     global_data_t *global = (global_data_t *)args;
-    dbprintlf("Checkpoint 1.");
+    dbprintlf_trc(LOG_MOD_SWUPD, "Checkpoint 1.");
     char directory[20];
     snprintf(directory, 20, global->directory);
-    dbprintlf("Checkpoint 2.");
+    dbprintlf_trc(LOG_MOD_SWUPD, "Checkpoint 2.");
     char filename[20];
     snprintf(filename, 20, global->filename);
-    dbprintlf("Checkpoint 3.");
+    dbprintlf_trc(LOG_MOD_SWUPD, "Checkpoint 3.");
 
     // int gs_sw_send_file(global_data_t *global_data, const char directory[], const char filename[], bool *done_upld)
     // {
     if (!global->network_data->connection_ready)
     {
-        dbprintlf("Checkpoint 4.");
-        dbprintlf(RED_FG "Connection is not ready: update aborted.");
+        dbprintlf_trc(LOG_MOD_SWUPD, "Checkpoint 4.");
+        dbprintlf_err(LOG_MOD_SWUPD, RED_FG "Connection is not ready: update aborted.");
         global->sw_updating = false;
         return NULL;
     }
     if (filename == NULL)
     {
-        dbprintlf("Checkpoint 4.");
-        dbprintlf(RED_FG "File name not supplied.");
+        dbprintlf_trc(LOG_MOD_SWUPD, "Checkpoint 4.");
+        dbprintlf_err(LOG_MOD_SWUPD, RED_FG "File name not supplied.");
         global->sw_updating = false;
         return NULL;
     }
     else if (strlen(filename) >= SW_UPD_FN_SIZE)
     {
-        dbprintlf("Checkpoint 4.");
-        dbprintlf(RED_FG "File name too long.");
+        dbprintlf_trc(LOG_MOD_SWUPD, "Checkpoint 4.");
+        dbprintlf_err(LOG_MOD_SWUPD, RED_FG "File name too long.");
         global->sw_updating = false;
         return NULL;
     }
-    dbprintlf("Checkpoint 4.");
+    dbprintlf_trc(LOG_MOD_SWUPD, "Checkpoint 4.");
     char directory_filename[SW_UPD_FN_SIZE + 32];
     snprintf(directory_filename, sizeof(directory_filename), "%s%s", directory, filename);
     FILE *bin_fp = fopen(directory_filename, "rb");
 
     if (bin_fp == NULL)
     {
-        dbprintlf(RED_FG "Could not open %s.", directory_filename);
+        dbprintlf_err(LOG_MOD_SWUPD, RED_FG "Could not open %s.", directory_filename);
         global->sw_updating = false;
         return NULL;
     }
@@ -554,13 +1270,13 @@ void *gs_sw_send_file_thread(void *args)
     ssize_t file_size = ftell(bin_fp);
     fseek(bin_fp, 0, SEEK_SET);
 
-    dbprintlf("Beginning send of %s (%d bytes).", directory_filename, file_size);
+    dbprintlf_inf(LOG_MOD_SWUPD, "Beginning send of %s (%d bytes).", directory_filename, file_size);
 
     ssize_t sent_bytes = gs_sw_get_sent_bytes(filename);
 
     if (sent_bytes < 0)
     {
-        dbprintlf(RED_FG "Failed to retrieve sent bytes for %s (%d).", directory_filename, sent_bytes);
+        dbprintlf_err(LOG_MOD_SWUPD, RED_FG "Failed to retrieve sent bytes for %s (%d).", directory_filename, sent_bytes);
         global->sw_updating = false;
         return NULL;
     }
@@ -578,7 +1294,7 @@ void *gs_sw_send_file_thread(void *args)
     char rd_buf[SW_UPD_PACKET_SIZE];
     char wr_buf[SW_UPD_PACKET_SIZE];
 
-    dbprintlf("Entering file transfer phase.");
+    dbprintlf_inf(LOG_MOD_SWUPD, "Entering file transfer phase.");
 
     // Outer loop. Runs until we have sent the entire file.
     while ((mode != finish) && global->sw_updating)
@@ -609,32 +1325,30 @@ void *gs_sw_send_file_thread(void *args)
             // Send the START/RESUME primer, and get back a reply
             for (send_attempts = 0; (send_attempts < SW_UPD_MAX_SEND_ATTEMPTS) && global->sw_updating; send_attempts++)
             {
-                dbprintlf("Sending S/R primer.");
+                lgprintlf_dbg(LOG_MOD_SWUPD, "Sending S/R primer.");
 
                 // retval = gs_transmit(global->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, wr_buf, SW_UPD_PACKET_SIZE);
-                NetFrame *network_frame = new NetFrame((unsigned char *)wr_buf, SW_UPD_PACKET_SIZE, NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                retval = global->tx_engine->submit(wr_buf, SW_UPD_PACKET_SIZE, NetType::DATA, NetVertex::ROOFUHF, TX_ORIGIN_SW_UPD);
 
                 if (retval <= 0)
                 {
-                    dbprintlf(RED_FG "S/R primer writing failed (%d).", retval);
+                    dbprintlf_err(LOG_MOD_SWUPD, RED_FG "S/R primer writing failed (%d).", retval);
                     continue;
                 }
 
-                dbprintlf("Will await N/ACK.");
+                lgprintlf_dbg(LOG_MOD_SWUPD, "Will await N/ACK.");
                 memset(rd_buf, 0x0, SW_UPD_PACKET_SIZE);
 
                 // TODO: Figure out a better way to wait for new data.
                 while (!global->sw_output_fresh && global->sw_updating)
                 {
-                    dbprintlf("Waiting for response...");
+                    lgprintlf_trc(LOG_MOD_SWUPD, "Waiting for response...");
                     usleep(0.1 SEC);
                 }
                 if (!global->sw_updating)
                 {
                     // Update aborted.
-                    dbprintlf(YELLOW_FG "Update aborted.");
+                    dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Update aborted.");
                     return NULL;
                 }
 
@@ -654,12 +1368,12 @@ void *gs_sw_send_file_thread(void *args)
                 else if (retval == ETIMEDOUT)
                 {
                     // NOTE: Continues if timeout.
-                    dbprintlf(YELLOW_FG "Lock acquisition timed out: failed to receive a response from SPACE-HAUC.");
+                    dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Lock acquisition timed out: failed to receive a response from SPACE-HAUC.");
                     continue;
                 }
                 else
                 {
-                    dbprintlf(FATAL "Failed to acquire sw_data_lock.");
+                    dbprintlf_err(LOG_MOD_SWUPD, FATAL "Failed to acquire sw_data_lock.");
                     continue;
                 }
 
@@ -669,7 +1383,7 @@ void *gs_sw_send_file_thread(void *args)
 
                 if (!memcmp(rept_cmd, rd_buf, 5))
                 { // We read in a REPT CMD, so repeat last.
-                    dbprintlf(YELLOW_FG "Repeat of previous transmission requested.");
+                    dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Repeat of previous transmission requested.");
                     continue;
                 }
 
@@ -703,7 +1417,7 @@ void *gs_sw_send_file_thread(void *args)
             if (!global->sw_updating)
             {
                 // Update aborted.
-                dbprintlf(YELLOW_FG "Update aborted.");
+                dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Update aborted.");
                 return NULL;
             }
 
@@ -725,7 +1439,7 @@ void *gs_sw_send_file_thread(void *args)
 
                 if (in_sz <= 0)
                 {
-                    dbprintlf(RED_FG "Reached EOF when retrieving packet %d.", sent_packets);
+                    dbprintlf_err(LOG_MOD_SWUPD, RED_FG "Reached EOF when retrieving packet %d.", sent_packets);
                     break;
                 }
 
@@ -737,23 +1451,21 @@ void *gs_sw_send_file_thread(void *args)
                 memcpy(wr_buf, dt_hdr, sizeof(sw_upd_data_t));
 
                 // retval = gs_transmit(global->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, wr_buf, SW_UPD_PACKET_SIZE);
-                NetFrame *network_frame = new NetFrame((unsigned char *)wr_buf,  SW_UPD_PACKET_SIZE, NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                retval = global->tx_engine->submit(wr_buf, SW_UPD_PACKET_SIZE, NetType::DATA, NetVertex::ROOFUHF, TX_ORIGIN_SW_UPD);
 
                 if (retval <= 0)
                 {
-                    dbprintlf(RED_FG "DATA packet writing failed (%d).", retval);
+                    dbprintlf_err(LOG_MOD_SWUPD, RED_FG "DATA packet writing failed (%d).", retval);
                     continue;
                 }
 
-                dbprintlf("Will await N/ACK.");
+                lgprintlf_dbg(LOG_MOD_SWUPD, "Will await N/ACK.");
                 memset(rd_buf, 0x0, SW_UPD_PACKET_SIZE);
 
                 // TODO: Figure out a better way to wait for new data.
                 while (!global->sw_output_fresh && global->sw_updating)
                 {
-                    dbprintlf("Waiting for response...");
+                    lgprintlf_trc(LOG_MOD_SWUPD, "Waiting for response...");
                     usleep(0.1 SEC);
                 }
 
@@ -773,12 +1485,12 @@ void *gs_sw_send_file_thread(void *args)
                 else if (retval == ETIMEDOUT)
                 {
                     // NOTE: Continues if timeout.
-                    dbprintlf(YELLOW_FG "Lock acquisition timed out: failed to receive a response from SPACE-HAUC.");
+                    dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Lock acquisition timed out: failed to receive a response from SPACE-HAUC.");
                     continue;
                 }
                 else
                 {
-                    dbprintlf(FATAL "Failed to acquire sw_data_lock.");
+                    dbprintlf_err(LOG_MOD_SWUPD, FATAL "Failed to acquire sw_data_lock.");
                     continue;
                 }
 
@@ -788,7 +1500,7 @@ void *gs_sw_send_file_thread(void *args)
 
                 if (!memcmp(rept_cmd, rd_buf, 5))
                 { // We read in a REPT CMD, so repeat last.
-                    dbprintlf(YELLOW_FG "Repeat of previous transmission requested.");
+                    dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Repeat of previous transmission requested.");
                     continue;
                 }
 
@@ -822,7 +1534,7 @@ void *gs_sw_send_file_thread(void *args)
             if (!global->sw_updating)
             {
                 // Update aborted.
-                dbprintlf(YELLOW_FG "Update aborted.");
+                dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Update aborted.");
                 return NULL;
             }
             break; // case data
@@ -833,17 +1545,17 @@ void *gs_sw_send_file_thread(void *args)
             if (sent_bytes == file_size)
             {
                 // Complete
-                dbprintlf("File transfer complete with %ld/%ld bytes of %s having been successfully sent and confirmed per packet.", sent_bytes, file_size, filename);
+                dbprintlf_inf(LOG_MOD_SWUPD, "File transfer complete with %ld/%ld bytes of %s having been successfully sent and confirmed per packet.", sent_bytes, file_size, filename);
             }
             else if (global->sw_updating)
             {
                 // Interrupted
-                dbprintlf(YELLOW_FG "File transfer interrupted with %ld/%ld bytes of %s having been successfully sent and confirmed per packet.", sent_bytes, file_size, filename);
+                dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "File transfer interrupted with %ld/%ld bytes of %s having been successfully sent and confirmed per packet.", sent_bytes, file_size, filename);
             }
             else if (sent_bytes <= 0)
             {
                 // Error
-                dbprintlf(RED_FG "An error has been encountered with %ld/%ld bytes of %s sent.", sent_bytes, file_size, filename);
+                dbprintlf_err(LOG_MOD_SWUPD, RED_FG "An error has been encountered with %ld/%ld bytes of %s sent.", sent_bytes, file_size, filename);
                 global->sw_updating = false;
                 return NULL;
             }
@@ -851,7 +1563,7 @@ void *gs_sw_send_file_thread(void *args)
             {
                 /// NOTE: Will reach this case if (recv_bytes != file_size).
                 // ???
-                dbprintlf(FATAL "Confused.");
+                dbprintlf_err(LOG_MOD_SWUPD, FATAL "Confused.");
                 global->sw_updating = false;
                 return NULL;
             }
@@ -873,29 +1585,27 @@ void *gs_sw_send_file_thread(void *args)
             checksum_md5(directory_filename, cf_hdr->hash, 32);
 
             // retval = gs_transmit(global->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, wr_buf, SW_UPD_PACKET_SIZE);
-            NetFrame *network_frame = new NetFrame((unsigned char *)wr_buf,  SW_UPD_PACKET_SIZE, NetType::DATA, NetVertex::ROOFUHF);
-            network_frame->sendFrame(global->network_data);
-            delete network_frame;
+            retval = global->tx_engine->submit(wr_buf, SW_UPD_PACKET_SIZE, NetType::DATA, NetVertex::ROOFUHF, TX_ORIGIN_SW_UPD);
 
             if (retval <= 0)
             {
-                dbprintlf(RED_FG "CF header writing failed (%d).", retval);
+                dbprintlf_err(LOG_MOD_SWUPD, RED_FG "CF header writing failed (%d).", retval);
                 continue;
             }
 
-            dbprintlf("Will await N/ACK.");
+            lgprintlf_dbg(LOG_MOD_SWUPD, "Will await N/ACK.");
             memset(rd_buf, 0x0, SW_UPD_PACKET_SIZE);
 
             // TODO: Figure out a better way to wait for new data.
             while (!global->sw_output_fresh && global->sw_updating)
             {
-                dbprintlf("Waiting for response...");
+                lgprintlf_trc(LOG_MOD_SWUPD, "Waiting for response...");
                 usleep(0.1 SEC);
             }
             if (!global->sw_updating)
             {
                 // Update aborted.
-                dbprintlf(YELLOW_FG "Update aborted.");
+                dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Update aborted.");
                 return NULL;
             }
 
@@ -915,12 +1625,12 @@ void *gs_sw_send_file_thread(void *args)
             else if (retval == ETIMEDOUT)
             {
                 // NOTE: Continues if timeout.
-                dbprintlf(YELLOW_FG "Lock acquisition timed out: failed to receive a response from SPACE-HAUC.");
+                dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Lock acquisition timed out: failed to receive a response from SPACE-HAUC.");
                 continue;
             }
             else
             {
-                dbprintlf(FATAL "Failed to acquire sw_data_lock.");
+                dbprintlf_err(LOG_MOD_SWUPD, FATAL "Failed to acquire sw_data_lock.");
                 continue;
             }
 
@@ -930,7 +1640,7 @@ void *gs_sw_send_file_thread(void *args)
 
             if (!memcmp(rept_cmd, rd_buf, 5))
             { // We read in a REPT CMD, so repeat last.
-                dbprintlf(YELLOW_FG "Repeat of previous transmission requested.");
+                dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "Repeat of previous transmission requested.");
                 continue;
             }
 
@@ -963,7 +1673,7 @@ void *gs_sw_send_file_thread(void *args)
             }
             else if (memcmp(cf_rep->hash, cf_hdr->hash, SW_UPD_HASH_SIZE) != 0)
             {
-                dbprintlf(FATAL "Restarting file transfer.");
+                dbprintlf_err(LOG_MOD_SWUPD, FATAL "Restarting file transfer.");
                 sent_packets = 0;
                 sent_bytes = 0;
                 gs_sw_set_sent_bytes(filename, 0);
@@ -971,7 +1681,7 @@ void *gs_sw_send_file_thread(void *args)
             }
             else
             {
-                dbprintlf(BLUE_BG "File transfer complete.");
+                dbprintlf_inf(LOG_MOD_SWUPD, BLUE_BG "File transfer complete.");
                 mode = finish;
             }
 
@@ -980,7 +1690,7 @@ void *gs_sw_send_file_thread(void *args)
 
         case finish:
         {
-            dbprintlf("The file transfer is now complete.");
+            dbprintlf_inf(LOG_MOD_SWUPD, "The file transfer is now complete.");
             global->sw_upd_packet = -1;
             break; // case finish
         }
@@ -1006,15 +1716,15 @@ ssize_t gs_sw_get_sent_bytes(const char filename[])
         bytes_fp = open(filename_bytes, O_RDONLY);
         if (bytes_fp < 3)
         {
-            dbprintlf(RED_FG "%s exists but could not be opened.", filename_bytes);
+            dbprintlf_err(LOG_MOD_SWUPD, RED_FG "%s exists but could not be opened.", filename_bytes);
             return ERR_FILE_OPEN;
         }
         lseek(bytes_fp, 0, SEEK_SET);
         if (read(bytes_fp, &sent_bytes, sizeof(ssize_t)) != sizeof(ssize_t))
         {
-            dbprintlf(RED_FG "Error reading sent_bytes.");
+            dbprintlf_err(LOG_MOD_SWUPD, RED_FG "Error reading sent_bytes.");
         }
-        dbprintlf(YELLOW_FG "%ld bytes of current transfer previously received by SH.", sent_bytes);
+        dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "%ld bytes of current transfer previously received by SH.", sent_bytes);
         close(bytes_fp);
     }
     else
@@ -1023,16 +1733,16 @@ ssize_t gs_sw_get_sent_bytes(const char filename[])
         bytes_fp = open(filename_bytes, O_CREAT | O_EXCL, 0755);
         if (bytes_fp < 3)
         {
-            dbprintlf(RED_FG "%s does not exist and could not be created.", filename_bytes);
+            dbprintlf_err(LOG_MOD_SWUPD, RED_FG "%s does not exist and could not be created.", filename_bytes);
             return ERR_FILE_OPEN;
         }
         lseek(bytes_fp, 0, SEEK_SET);
         int retval = write(bytes_fp, &sent_bytes, sizeof(ssize_t));
         if (retval != sizeof(ssize_t))
         {
-            dbprintlf(RED_FG "Error %d", retval);
+            dbprintlf_err(LOG_MOD_SWUPD, RED_FG "Error %d", retval);
         }
-        dbprintlf(YELLOW_FG "%s does not exist. Assuming transfer should start at packet 0.", filename_bytes);
+        dbprintlf_wrn(LOG_MOD_SWUPD, YELLOW_FG "%s does not exist. Assuming transfer should start at packet 0.", filename_bytes);
         close(bytes_fp);
     }
     sync();
@@ -1049,13 +1759,13 @@ int gs_sw_set_sent_bytes(const char filename[], ssize_t sent_bytes)
     bytes_fp = open(filename_bytes, O_RDWR | O_TRUNC);
     if (bytes_fp < 3)
     {
-        dbprintlf(RED_FG "Could not open %s for overwriting.", filename_bytes);
+        dbprintlf_err(LOG_MOD_SWUPD, RED_FG "Could not open %s for overwriting.", filename_bytes);
         return ERR_FILE_OPEN;
     }
     lseek(bytes_fp, 0, SEEK_SET);
     if (write(bytes_fp, &sent_bytes, sizeof(ssize_t)) != sizeof(ssize_t))
     {
-        dbprintlf(RED_FG "Could not write to %s", filename_bytes);
+        dbprintlf_err(LOG_MOD_SWUPD, RED_FG "Could not write to %s", filename_bytes);
     }
     close(bytes_fp);
 
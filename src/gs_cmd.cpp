@@ -0,0 +1,353 @@
+/**
+ * @file gs_cmd.cpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Correlates commands sent to SPACE-HAUC with their replies.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include <string.h>
+#include "gs_cmd.hpp"
+#include "meb_debug.hpp"
+
+CmdTracker::CmdTracker() : num_inflight(0), next_seq(1), done_head(0), num_done(0), num_stats(0), unsent_head(0)
+{
+    memset(inflight, 0x0, sizeof(inflight));
+    memset(done, 0x0, sizeof(done));
+    memset(table, 0x0, sizeof(table));
+    memset(unsent_tags, 0x0, sizeof(unsent_tags));
+
+    for (int i = 0; i < 256; i++)
+    {
+        timeouts[i] = CMD_TIMEOUT_DEFAULT;
+    }
+}
+
+CmdTracker::~CmdTracker()
+{
+    for (int i = 0; i < num_stats; i++)
+    {
+        delete table[i].rtt;
+    }
+}
+
+uint32_t CmdTracker::track(int mod, int cmd, int origin, int tx_tag, int timeout_ms, uint64_t t_sent)
+{
+    if (num_inflight >= CMD_INFLIGHT_MAX)
+    {
+        dbprintlf_wrn(LOG_MOD_GEN, YELLOW_FG "In-flight command table full; not tracking 0x%02x/0x%02x.", mod, cmd);
+        return 0;
+    }
+
+    if (timeout_ms <= 0)
+    {
+        timeout_ms = timeout(mod);
+    }
+
+    cmd_pending_t *req = NULL;
+    for (int i = 0; i < CMD_INFLIGHT_MAX; i++)
+    {
+        if (!inflight[i].used)
+        {
+            req = &inflight[i];
+            break;
+        }
+    }
+
+    uint32_t seq = next_seq++;
+    if (next_seq == 0)
+    {
+        next_seq = 1;
+    }
+
+    req->used = true;
+    req->seq = seq;
+    req->mod = mod;
+    req->cmd = cmd;
+    req->origin = origin;
+    req->tx_tag = tx_tag;
+    req->t_sent = t_sent > 0 ? t_sent : lat_now_ns();
+    req->deadline = req->t_sent + (uint64_t)timeout_ms * 1000000ULL;
+    num_inflight++;
+
+    cmd_stats_t *stat = find_stats(mod, cmd);
+    if (stat != NULL)
+    {
+        stat->sent++;
+    }
+
+    // Its frame may already have failed; tags are never reused, so a match is this request's.
+    for (int i = 0; i < CMD_UNSENT_LEN; i++)
+    {
+        if (tx_tag > 0 && unsent_tags[i] == tx_tag)
+        {
+            unsent_tags[i] = 0;
+            unsent(tx_tag);
+            break;
+        }
+    }
+
+    return seq;
+}
+
+void CmdTracker::unsent(int tx_tag)
+{
+    for (int i = 0; i < CMD_INFLIGHT_MAX && num_inflight > 0; i++)
+    {
+        cmd_pending_t *req = &inflight[i];
+        if (req->used && req->tx_tag == tx_tag)
+        {
+            dbprintlf_wrn(LOG_MOD_GEN, YELLOW_FG "Command #%u (0x%02x/0x%02x) was not sent.", req->seq, req->mod, req->cmd);
+            req->used = false;
+            num_inflight--;
+            finish(req->mod, req->cmd, req->seq, CMD_STATUS_NOT_SENT, 0, NULL, 0, 0);
+            return;
+        }
+    }
+
+    unsent_tags[unsent_head] = tx_tag;
+    unsent_head = (unsent_head + 1) % CMD_UNSENT_LEN;
+}
+
+uint32_t CmdTracker::reply(int mod, int cmd, int retval, const unsigned char *data, int data_size, uint64_t t_recv)
+{
+    // Oldest pending request for this key. Compared as a signed difference so the order holds across the wrap of next_seq; pending requests are never two billion apart.
+    cmd_pending_t *match = NULL;
+    for (int i = 0; i < CMD_INFLIGHT_MAX; i++)
+    {
+        cmd_pending_t *req = &inflight[i];
+        if (req->used && req->mod == mod && req->cmd == cmd && (match == NULL || (int32_t)(req->seq - match->seq) < 0))
+        {
+            match = req;
+        }
+    }
+
+    if (match == NULL)
+    {
+        dbprintlf_dbg(LOG_MOD_GEN, "Reply 0x%02x/0x%02x matches no pending command.", mod, cmd);
+        finish(mod, cmd, 0, CMD_STATUS_UNMATCHED, retval, data, data_size, 0);
+        return 0;
+    }
+
+    uint32_t seq = match->seq;
+    uint64_t rtt = t_recv > match->t_sent ? t_recv - match->t_sent : 0;
+    match->used = false;
+    num_inflight--;
+
+    finish(mod, cmd, seq, CMD_STATUS_ANSWERED, retval, data, data_size, rtt);
+    return seq;
+}
+
+int CmdTracker::expire(uint64_t now)
+{
+    int count = 0;
+
+    for (int i = 0; i < CMD_INFLIGHT_MAX && num_inflight > 0; i++)
+    {
+        cmd_pending_t *req = &inflight[i];
+        if (req->used && now >= req->deadline)
+        {
+            dbprintlf_wrn(LOG_MOD_GEN, YELLOW_FG "Command #%u (0x%02x/0x%02x) timed out.", req->seq, req->mod, req->cmd);
+            req->used = false;
+            num_inflight--;
+            finish(req->mod, req->cmd, req->seq, CMD_STATUS_TIMED_OUT, 0, NULL, 0, 0);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void CmdTracker::finish(int mod, int cmd, uint32_t seq, int status, int retval, const unsigned char *data, int data_size, uint64_t rtt)
+{
+    cmd_done_t *entry = &done[done_head];
+    done_head = (done_head + 1) % CMD_HISTORY_LEN;
+    if (num_done < CMD_HISTORY_LEN)
+    {
+        num_done++;
+    }
+
+    if (data_size < 0)
+    {
+        data_size = 0;
+    }
+    else if (data_size > CMD_DATA_LEN)
+    {
+        data_size = CMD_DATA_LEN;
+    }
+
+    entry->seq = seq;
+    entry->mod = mod;
+    entry->cmd = cmd;
+    entry->status = status;
+    entry->retval = retval;
+    entry->data_size = data_size;
+    entry->rtt = rtt;
+    if (data_size > 0)
+    {
+        memcpy(entry->data, data, data_size);
+    }
+
+    cmd_stats_t *stat = find_stats(mod, cmd);
+    if (stat == NULL)
+    {
+        return;
+    }
+
+    switch (status)
+    {
+    case CMD_STATUS_ANSWERED:
+        stat->answered++;
+        stat->rtt->record(rtt);
+        break;
+    case CMD_STATUS_TIMED_OUT:
+        stat->timed_out++;
+        break;
+    case CMD_STATUS_UNMATCHED:
+        stat->unmatched++;
+        break;
+    case CMD_STATUS_NOT_SENT:
+        stat->not_sent++;
+        break;
+    }
+}
+
+cmd_stats_t *CmdTracker::find_stats(int mod, int cmd)
+{
+    for (int i = 0; i < num_stats; i++)
+    {
+        if (table[i].mod == mod && table[i].cmd == cmd)
+        {
+            return &table[i];
+        }
+    }
+
+    if (num_stats >= CMD_STATS_MAX)
+    {
+        return NULL;
+    }
+
+    cmd_stats_t *stat = &table[num_stats++];
+    stat->mod = mod;
+    stat->cmd = cmd;
+    stat->rtt = new LatencyHistogram();
+    return stat;
+}
+
+void CmdTracker::set_timeout(int mod, int timeout_ms)
+{
+    if (mod >= 0 && mod < 256 && timeout_ms > 0)
+    {
+        timeouts[mod] = timeout_ms;
+    }
+}
+
+int CmdTracker::timeout(int mod)
+{
+    if (mod < 0 || mod >= 256)
+    {
+        return CMD_TIMEOUT_DEFAULT;
+    }
+    return timeouts[mod];
+}
+
+int CmdTracker::pending_count()
+{
+    return num_inflight;
+}
+
+const cmd_pending_t *CmdTracker::pending(int idx)
+{
+    if (idx < 0 || idx >= CMD_INFLIGHT_MAX || !inflight[idx].used)
+    {
+        return NULL;
+    }
+    return &inflight[idx];
+}
+
+int CmdTracker::lookup(uint32_t seq, cmd_done_t *out)
+{
+    for (int i = 0; i < CMD_INFLIGHT_MAX; i++)
+    {
+        if (inflight[i].used && inflight[i].seq == seq)
+        {
+            return CMD_STATUS_PENDING;
+        }
+    }
+
+    for (int i = 0; i < num_done; i++)
+    {
+        const cmd_done_t *entry = history(i);
+        if (entry->seq == seq)
+        {
+            *out = *entry;
+            return entry->status;
+        }
+    }
+
+    return -1;
+}
+
+int CmdTracker::history_count()
+{
+    return num_done;
+}
+
+const cmd_done_t *CmdTracker::history(int idx)
+{
+    if (idx < 0 || idx >= num_done)
+    {
+        return NULL;
+    }
+    return &done[(done_head - 1 - idx + CMD_HISTORY_LEN) % CMD_HISTORY_LEN];
+}
+
+int CmdTracker::stats_count()
+{
+    return num_stats;
+}
+
+const cmd_stats_t *CmdTracker::stats(int idx)
+{
+    if (idx < 0 || idx >= num_stats)
+    {
+        return NULL;
+    }
+    return &table[idx];
+}
+
+void CmdTracker::reset_stats()
+{
+    for (int i = 0; i < num_stats; i++)
+    {
+        table[i].sent = 0;
+        table[i].answered = 0;
+        table[i].timed_out = 0;
+        table[i].unmatched = 0;
+        table[i].not_sent = 0;
+        table[i].rtt->reset();
+    }
+}
+
+const char *CmdTracker::status_name(int status)
+{
+    switch (status)
+    {
+    case CMD_STATUS_PENDING:
+        return "PENDING";
+    case CMD_STATUS_ANSWERED:
+        return "ANSWERED";
+    case CMD_STATUS_TIMED_OUT:
+        return "TIMED OUT";
+    case CMD_STATUS_UNMATCHED:
+        return "UNMATCHED";
+    case CMD_STATUS_NOT_SENT:
+        return "NOT SENT";
+    default:
+        return "UNKNOWN";
+    }
+}
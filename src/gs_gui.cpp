@@ -17,10 +17,45 @@
 #include <pthread.h>
 #include "gs.hpp"
 #include "gs_gui.hpp"
+#include "gs_half.hpp"
 #include "meb_debug.hpp"
 #include "sw_update_packdef.h"
 
-int gs_gui_gs2sh_tx_handler(NetDataClient *network_data, int access_level, cmd_input_t *command_input, bool allow_transmission)
+void gs_gui_tx_status(global_data_t *global, int origin)
+{
+    const tx_event_t *event = global->tx_engine->last_event(origin);
+    if (event == NULL || event->status == TX_STATUS_NONE)
+    {
+        ImGui::TextDisabled("Last Transmission: None");
+        return;
+    }
+
+    ImVec4 color = event->status == TX_STATUS_SENT ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
+    ImGui::Text("Last Transmission:");
+    ImGui::SameLine();
+    ImGui::TextColored(color, "%s", TxEngine::status_name(event->status));
+    ImGui::SameLine();
+    if (event->status == TX_STATUS_FAILED)
+    {
+        ImGui::Text("(#%u, %s)", event->tag, strerror(event->err));
+    }
+    else
+    {
+        ImGui::Text("(#%u, %.2f ms after submission)", event->tag, (event->t_done - event->t_submit) / 1e6);
+    }
+}
+
+uint32_t gs_gui_cmd_send(global_data_t *global, const cmd_input_t *command_input, int origin)
+{
+    int tag = global->tx_engine->submit(*command_input, NetType::DATA, NetVertex::ROOFUHF, origin, gs_cmd_tx_class(command_input->mod));
+    if (tag <= 0)
+    {
+        return 0;
+    }
+    return global->cmd_tracker->track(command_input->mod, command_input->cmd, origin, tag);
+}
+
+int gs_gui_gs2sh_tx_handler(global_data_t *global, int origin, int access_level, cmd_input_t *command_input, bool allow_transmission)
 {
     if (!allow_transmission)
     {
@@ -55,10 +90,9 @@ int gs_gui_gs2sh_tx_handler(NetDataClient *network_data, int access_level, cmd_i
     {
         // Send the transmission.
         // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, command_input, sizeof(cmd_input_t));
-        NetFrame *network_frame = new NetFrame((unsigned char *)command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-        network_frame->sendFrame(network_data);
-        delete network_frame;
+        gs_gui_cmd_send(global, command_input, origin);
     }
+    gs_gui_tx_status(global, origin);
 
     if (access_level <= 1)
     {
@@ -159,6 +193,22 @@ void gs_gui_settings_window(bool *SETTINGS_window, int access_level, global_data
         ImGui::Text("Split ACS update graphs into multiple windows?");
         ImGui::Checkbox("ACS Multiple Windows", &global->settings->acs_multiple_windows);
         ImGui::Checkbox("Show Tooltips", &global->settings->tooltips);
+
+        ImGui::Separator();
+        ImGui::Text("Log Levels (compiled up to %d)", GS_LOG_LEVEL);
+        static const char *log_mod_names[LOG_MOD_COUNT] = {"General", "Receive", "Transmit", "Software Update", "GUI"};
+        for (int mod = 0; mod < LOG_MOD_COUNT; mod++)
+        {
+            int lvl = meb_log_get_level(mod);
+            if (ImGui::SliderInt(log_mod_names[mod], &lvl, LOG_LVL_NONE, GS_LOG_LEVEL))
+            {
+                meb_log_set_level(mod, lvl);
+            }
+        }
+        if (global->settings->tooltips && ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("0: None, 1: Errors, 2: Warnings, 3: Info, 4: Debug, 5: Trace.");
+        }
     }
     ImGui::End();
 }
@@ -172,8 +222,6 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
     static acs_set_data_t acs_set_data = {0};
     static acs_set_data_holder_t acs_set_data_holder = {0};
 
-    static bool acs_rxtx_automated = false;
-    static pthread_t acs_thread_id;
 
     if (ImGui::Begin("ACS Operations", ACS_window))
     {
@@ -199,9 +247,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Moment of Intertia (MOI)");
@@ -214,9 +260,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Inverse Moment of Inertia (IMOI)");
@@ -229,9 +273,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Dipole");
@@ -244,9 +286,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Timestep");
@@ -259,9 +299,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Measure Time");
@@ -274,9 +312,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Leeway (Z-Angular Momentum Target Tolerable Error)");
@@ -289,9 +325,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get W-Target (Angular Momentum Target Vector");
@@ -304,9 +338,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Detumble Angle");
@@ -319,9 +351,7 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ACS_command_input.data_size = 0x0;
                 memset(ACS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &ACS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&ACS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(global->network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &ACS_command_input, TX_ORIGIN_ACS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Sun Angle");
@@ -449,33 +479,47 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 ImGui::PushStyleColor(0, ImVec4(0.3f, 0.3f, 0.3f, 1.0f));
             }
 
+            AcsPoller *poller = global->acs_poller;
+
             if (ImGui::Button("Send One ACS Update Request") && allow_transmission)
             {
-                // Spawn a new thread to run
-                if (pthread_mutex_trylock(&global->acs_rolbuf->acs_upd_inhibitor) == 0)
-                {
-                    pthread_create(&acs_thread_id, NULL, gs_acs_update_thread, global);
-                }
+                poller->poll_once();
             }
 
-            ImGui::Text("ACS Data-down Update (every 100ms)");
+            int poll_period = poller->period();
+            ImGui::Text("ACS Data-down Update (every %d ms, %.2f Hz)", poll_period, 1000.0 / poll_period);
+            ImGui::Text("Update Loss: %.1f%% (%lu answered, %lu lost)", poller->loss() * 100, (unsigned long)poller->answered.load(), (unsigned long)poller->lost.load());
+            bool poll_adaptive = poller->adaptive();
+            if (ImGui::Checkbox("Adapt Rate to Loss", &poll_adaptive))
+            {
+                poller->set_adaptive(poll_adaptive);
+            }
+            if (global->settings->tooltips && ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Speeds up toward 2 Hz while updates keep arriving and halves the rate when they start going missing. Setting the period by hand turns this off.");
+            }
+            if (ImGui::InputInt("Period (ms)", &poll_period, 100, 1000))
+            {
+                poller->set_period(poll_period);
+            }
             if (ImGui::Button("Toggle ACS Update") && allow_transmission)
             {
-                acs_rxtx_automated = !acs_rxtx_automated;
+                if (poller->active())
+                {
+                    poller->stop();
+                }
+                else
+                {
+                    poller->start();
+                }
             }
 
-            if (acs_rxtx_automated)
+            if (poller->active())
             {
                 ImGui::PushStyleColor(0, ImVec4(0.0f, 1.0f, 0.0f, 1.0f));
                 ImGui::SameLine();
                 ImGui::Text("ACTIVE");
                 ImGui::PopStyleColor();
-
-                // Spawn a thread to execute gs_acs_update_data_handler(...) once.
-                if (pthread_mutex_trylock(&global->acs_rolbuf->acs_upd_inhibitor) == 0)
-                {
-                    pthread_create(&acs_thread_id, NULL, gs_acs_update_thread, global);
-                }
             }
             else
             {
@@ -559,13 +603,13 @@ void gs_gui_acs_window(global_data_t *global, bool *ACS_window, int access_level
                 }
             }
 
-            gs_gui_gs2sh_tx_handler(global->network_data, access_level, &ACS_command_input, allow_transmission);
+            gs_gui_gs2sh_tx_handler(global, TX_ORIGIN_ACS, access_level, &ACS_command_input, allow_transmission);
         }
     }
     ImGui::End();
 }
 
-void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access_level, bool allow_transmission)
+void gs_gui_eps_window(global_data_t *global, bool *EPS_window, int access_level, bool allow_transmission)
 {
     ImGuiInputTextFlags_ flag = (ImGuiInputTextFlags_)0;
 
@@ -597,9 +641,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 EPS_command_input.data_size = 0x0;
                 memset(EPS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &EPS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&EPS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &EPS_command_input, TX_ORIGIN_EPS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Minimal Housekeeping");
@@ -612,9 +654,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 EPS_command_input.data_size = 0x0;
                 memset(EPS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &EPS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&EPS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &EPS_command_input, TX_ORIGIN_EPS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Battery Voltage");
@@ -627,9 +667,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 EPS_command_input.data_size = 0x0;
                 memset(EPS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &EPS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&EPS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &EPS_command_input, TX_ORIGIN_EPS);
             }
             ImGui::SameLine();
             ImGui::Text("Get System Current");
@@ -642,9 +680,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 EPS_command_input.data_size = 0x0;
                 memset(EPS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &EPS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&EPS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &EPS_command_input, TX_ORIGIN_EPS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Power Out");
@@ -657,9 +693,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 EPS_command_input.data_size = 0x0;
                 memset(EPS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &EPS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&EPS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &EPS_command_input, TX_ORIGIN_EPS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Solar Voltage");
@@ -672,9 +706,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 EPS_command_input.data_size = 0x0;
                 memset(EPS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &EPS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&EPS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &EPS_command_input, TX_ORIGIN_EPS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Solar Voltage (All)");
@@ -687,9 +719,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 EPS_command_input.data_size = 0x0;
                 memset(EPS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &EPS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&EPS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &EPS_command_input, TX_ORIGIN_EPS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Solar Generated Current (ISUN)");
@@ -702,9 +732,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 EPS_command_input.data_size = 0x0;
                 memset(EPS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &EPS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&EPS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &EPS_command_input, TX_ORIGIN_EPS);
             }
             ImGui::SameLine();
             ImGui::Text("Get Loop Timer");
@@ -791,7 +819,7 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
                 ImGui::PopStyleColor();
             }
 
-            gs_gui_gs2sh_tx_handler(network_data, access_level, &EPS_command_input, allow_transmission);
+            gs_gui_gs2sh_tx_handler(global, TX_ORIGIN_EPS, access_level, &EPS_command_input, allow_transmission);
         }
     }
     ImGui::End();
@@ -800,7 +828,6 @@ void gs_gui_eps_window(NetDataClient *network_data, bool *EPS_window, int access
 void gs_gui_xband_window(global_data_t *global, bool *XBAND_window, int access_level, bool allow_transmission)
 {
     ImGuiInputTextFlags_ flag = (ImGuiInputTextFlags_)0;
-    NetDataClient *network_data = global->network_data;
 
     static int XBAND_command = XBAND_INVALID_ID;
     static cmd_input_t XBAND_command_input = {.mod = INVALID_ID, .cmd = XBAND_INVALID_ID, .unused = 0, .data_size = 0};
@@ -834,9 +861,7 @@ void gs_gui_xband_window(global_data_t *global, bool *XBAND_window, int access_l
                 XBAND_command_input.data_size = 0x0;
                 memset(XBAND_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &XBAND_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&XBAND_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &XBAND_command_input, TX_ORIGIN_XBAND);
             }
             ImGui::SameLine();
             ImGui::Text("Get Max On");
@@ -849,9 +874,7 @@ void gs_gui_xband_window(global_data_t *global, bool *XBAND_window, int access_l
                 XBAND_command_input.data_size = 0x0;
                 memset(XBAND_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &XBAND_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&XBAND_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &XBAND_command_input, TX_ORIGIN_XBAND);
             }
             ImGui::SameLine();
             ImGui::Text("Get Shutdown Temperature (TMP SHDN)");
@@ -864,9 +887,7 @@ void gs_gui_xband_window(global_data_t *global, bool *XBAND_window, int access_l
                 XBAND_command_input.data_size = 0x0;
                 memset(XBAND_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &XBAND_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&XBAND_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &XBAND_command_input, TX_ORIGIN_XBAND);
             }
             ImGui::SameLine();
             ImGui::Text("Get Return to Operation Temperature (TMP OP)");
@@ -879,9 +900,7 @@ void gs_gui_xband_window(global_data_t *global, bool *XBAND_window, int access_l
                 XBAND_command_input.data_size = 0x0;
                 memset(XBAND_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(global_data->network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &XBAND_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&XBAND_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &XBAND_command_input, TX_ORIGIN_XBAND);
             }
             ImGui::SameLine();
             ImGui::Text("Get Loop Time");
@@ -1210,7 +1229,7 @@ void gs_gui_xband_window(global_data_t *global, bool *XBAND_window, int access_l
         }
         }
 
-        gs_gui_gs2sh_tx_handler(network_data, access_level, &XBAND_command_input, allow_transmission);
+        gs_gui_gs2sh_tx_handler(global, TX_ORIGIN_XBAND, access_level, &XBAND_command_input, allow_transmission);
     }
 
     ImGui::End();
@@ -1300,7 +1319,7 @@ void gs_gui_sw_upd_window(global_data_t *global, bool *SW_UPD_window, int access
     ImGui::End();
 }
 
-void gs_gui_sys_ctrl_window(NetDataClient *network_data, bool *SYS_CTRL_window, int access_level, bool allow_transmission)
+void gs_gui_sys_ctrl_window(global_data_t *global, bool *SYS_CTRL_window, int access_level, bool allow_transmission)
 {
     // static int SYS_command = INVALID_ID;
     static cmd_input_t SYS_command_input = {.mod = INVALID_ID, .cmd = INVALID_ID, .unused = 0, .data_size = 0};
@@ -1330,9 +1349,7 @@ void gs_gui_sys_ctrl_window(NetDataClient *network_data, bool *SYS_CTRL_window,
                 SYS_command_input.data_size = 0x0;
                 memset(SYS_command_input.data, 0x0, MAX_DATA_SIZE);
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_ROOFUHF, &SYS_command_input, sizeof(cmd_input_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&SYS_command_input, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                gs_gui_cmd_send(global, &SYS_command_input, TX_ORIGIN_SYS_CTRL);
             }
             ImGui::SameLine();
             ImGui::Text("Get Version Magic");
@@ -1420,7 +1437,7 @@ void gs_gui_sys_ctrl_window(NetDataClient *network_data, bool *SYS_CTRL_window,
                 }
                 ImGui::Unindent();
 
-                gs_gui_gs2sh_tx_handler(network_data, access_level, &SYS_command_input, allow_transmission);
+                gs_gui_gs2sh_tx_handler(global, TX_ORIGIN_SYS_CTRL, access_level, &SYS_command_input, allow_transmission);
 
                 if (access_level <= 2)
                 {
@@ -1459,18 +1476,109 @@ void gs_gui_rx_display_window(bool *RX_display, global_data_t *global)
         ImGui::Separator();
         ImGui::Separator();
 
+        CmdTracker *tracker = global->cmd_tracker;
+        uint64_t now = lat_now_ns();
+
+        ImGui::Text("SPACE-HAUC PENDING COMMANDS (%d)", tracker->pending_count());
+        ImGui::Separator();
+        ImGui::Columns(5, "cmd_pending_columns");
+        ImGui::Text("Seq");
+        ImGui::NextColumn();
+        ImGui::Text("Module");
+        ImGui::NextColumn();
+        ImGui::Text("Command");
+        ImGui::NextColumn();
+        ImGui::Text("Age (ms)");
+        ImGui::NextColumn();
+        ImGui::Text("Timeout (ms)");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < CMD_INFLIGHT_MAX; i++)
+        {
+            const cmd_pending_t *req = tracker->pending(i);
+            if (req == NULL)
+            {
+                continue;
+            }
+            ImGui::Text("%u", req->seq);
+            ImGui::NextColumn();
+            ImGui::Text("0x%02x", req->mod);
+            ImGui::NextColumn();
+            ImGui::Text("0x%02x", req->cmd);
+            ImGui::NextColumn();
+            ImGui::Text("%.0f", (now - req->t_sent) / 1e6);
+            ImGui::NextColumn();
+            ImGui::Text("%.0f", (req->deadline - req->t_sent) / 1e6);
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        ImGui::Separator();
+        ImGui::Separator();
+
         ImGui::Text("SPACE-HAUC COMMAND OUTPUT");
         ImGui::Separator();
-        ImGui::Text("Module ----------- %d", global->cmd_output->mod);
-        ImGui::Text("Command ---------- %d", global->cmd_output->cmd);
-        ImGui::Text("Return Value ----- %d", global->cmd_output->retval);
-        ImGui::Text("Data Size -------- %d", global->cmd_output->data_size);
-        ImGui::Text("Data (hex) ------- ");
-        for (int i = 0; i < global->cmd_output->data_size; i++)
+        ImGui::Columns(7, "cmd_done_columns");
+        ImGui::Text("Seq");
+        ImGui::NextColumn();
+        ImGui::Text("Module");
+        ImGui::NextColumn();
+        ImGui::Text("Command");
+        ImGui::NextColumn();
+        ImGui::Text("Status");
+        ImGui::NextColumn();
+        ImGui::Text("RTT (ms)");
+        ImGui::NextColumn();
+        ImGui::Text("Return Value");
+        ImGui::NextColumn();
+        ImGui::Text("Data (hex)");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < tracker->history_count(); i++)
         {
-            ImGui::SameLine(0.0F, 0.0F);
-            ImGui::Text("%2x", global->cmd_output->data[i]);
+            const cmd_done_t *done = tracker->history(i);
+            if (done->seq > 0)
+            {
+                ImGui::Text("%u", done->seq);
+            }
+            else
+            {
+                ImGui::Text("-");
+            }
+            ImGui::NextColumn();
+            ImGui::Text("0x%02x", done->mod);
+            ImGui::NextColumn();
+            ImGui::Text("0x%02x", done->cmd);
+            ImGui::NextColumn();
+            if (done->status == CMD_STATUS_ANSWERED)
+            {
+                ImGui::Text("%s", CmdTracker::status_name(done->status));
+            }
+            else
+            {
+                ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", CmdTracker::status_name(done->status));
+            }
+            ImGui::NextColumn();
+            if (done->status == CMD_STATUS_ANSWERED)
+            {
+                ImGui::Text("%.1f", done->rtt / 1e6);
+            }
+            ImGui::NextColumn();
+            if (done->status != CMD_STATUS_TIMED_OUT && done->status != CMD_STATUS_NOT_SENT)
+            {
+                ImGui::Text("%d", done->retval);
+            }
+            ImGui::NextColumn();
+            for (int j = 0; j < done->data_size; j++)
+            {
+                if (j > 0)
+                {
+                    ImGui::SameLine(0.0F, 0.0F);
+                }
+                ImGui::Text("%02x", done->data[j]);
+            }
+            ImGui::NextColumn();
         }
+        ImGui::Columns(1);
         ImGui::Separator();
         ImGui::Separator();
 
@@ -1480,6 +1588,64 @@ void gs_gui_rx_display_window(bool *RX_display, global_data_t *global)
         ImGui::Text("Roof UHF --------- %d", ((global->netstat & 0x40) == 0x40) ? 1 : 0);
         ImGui::Text("Roof X-Band ------ %d", ((global->netstat & 0x20) == 0x20) ? 1 : 0);
         ImGui::Text("Haystack --------- %d", ((global->netstat & 0x10) == 0x10) ? 1 : 0);
+        ImGui::Separator();
+        ImGui::Separator();
+
+        ImGui::Text("RECEIVE STREAM");
+        ImGui::Separator();
+        ImGui::Text("Reads ------------ %lu", (unsigned long)global->rx_stream->reads.load());
+        ImGui::Text("Bytes ------------ %lu", (unsigned long)global->rx_stream->bytes.load());
+        ImGui::Text("Frames ----------- %lu", (unsigned long)global->rx_stream->frames.load());
+        ImGui::Text("Max Frames/Read -- %lu", (unsigned long)global->rx_stream->max_per_read.load());
+        ImGui::Text("Wrapped ---------- %lu", (unsigned long)global->rx_stream->wrapped.load());
+        ImGui::Text("Bad Frames ------- %lu", (unsigned long)global->rx_stream->bad_frames.load());
+        ImGui::Text("CRC Mismatches --- %lu", (unsigned long)global->rx_stream->crc_mismatches.load());
+        ImGui::Text("Skipped Bytes ---- %lu", (unsigned long)global->rx_stream->skipped.load());
+        ImGui::Separator();
+        ImGui::Separator();
+
+        ImGui::Text("RECEIVE FRAME POOL");
+        ImGui::Separator();
+        ImGui::Text("Acquired --------- %lu", (unsigned long)global->rx_pool->acquired.load());
+        ImGui::Text("Released --------- %lu", (unsigned long)global->rx_pool->released.load());
+        ImGui::Text("Exhausted -------- %lu", (unsigned long)global->rx_pool->exhausted.load());
+        ImGui::Text("Heap Allocations - %lu", (unsigned long)global->rx_pool->heap_allocs.load());
+        ImGui::Separator();
+        ImGui::Separator();
+
+        ImGui::Text("RECEIVE HANDLERS");
+        ImGui::Separator();
+        ImGui::Columns(5, "rx_handler_columns");
+        ImGui::Text("Handler");
+        ImGui::NextColumn();
+        ImGui::Text("Calls");
+        ImGui::NextColumn();
+        ImGui::Text("Total (ms)");
+        ImGui::NextColumn();
+        ImGui::Text("Mean (us)");
+        ImGui::NextColumn();
+        ImGui::Text("Max (us)");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < global->rx_dispatcher->count(); i++)
+        {
+            const rx_handler_entry_t *entry = global->rx_dispatcher->entry(i);
+            uint64_t calls = entry->calls.load();
+            uint64_t ns_total = entry->ns_total.load();
+
+            ImGui::Text("%s", entry->name);
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)calls);
+            ImGui::NextColumn();
+            ImGui::Text("%.3f", ns_total / 1e6);
+            ImGui::NextColumn();
+            ImGui::Text("%.2f", calls > 0 ? (ns_total / 1e3) / calls : 0.0);
+            ImGui::NextColumn();
+            ImGui::Text("%.2f", entry->ns_max.load() / 1e3);
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        ImGui::Text("Unhandled -------- %lu", (unsigned long)global->rx_dispatcher->unhandled.load());
     }
     ImGui::End();
 }
@@ -1546,7 +1712,14 @@ void gs_gui_conns_manager_window(bool *CONNS_manager, int access_level, bool all
             {
                 last_connect_attempt_time = ImGui::GetTime();
 
+                // A connection dropped by another thread is only shut down; its descriptor is closed here, by the one thread that closes sockets.
+                if (network_data->socket >= 0)
+                {
+                    close(network_data->socket);
+                    network_data->socket = -1;
+                }
                 gui_connect_status = gs_connect_to_server(network_data);
+                global->rx_engine->wake();
                 // network_data->server_ip->sin_port = htons(destination_port);
                 // if ((network_data->socket = socket(AF_INET, SOCK_STREAM, 0)) < 0)
                 // {
@@ -1616,6 +1789,7 @@ void gs_gui_conns_manager_window(bool *CONNS_manager, int access_level, bool all
                 network_data->socket = -1;
                 strcpy(network_data->disconnect_reason, "USER");
                 network_data->connection_ready = false;
+                global->rx_engine->wake();
             }
         }
 
@@ -1670,10 +1844,9 @@ void gs_gui_conns_manager_window(bool *CONNS_manager, int access_level, bool all
             if (ImGui::Button("SEND TEST FRAME"))
             {
                 // gs_transmit(network_data, CS_TYPE_DATA, CS_ENDPOINT_CLIENT, NULL, 0);
-                NetFrame *network_frame = new NetFrame(NULL, 0, NetType::POLL, NetVertex::SERVER);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                global->tx_engine->submit(NULL, 0, NetType::POLL, NetVertex::SERVER, TX_ORIGIN_CONNS);
             }
+            gs_gui_tx_status(global, TX_ORIGIN_CONNS);
         }
 
         ImGui::End();
@@ -1683,7 +1856,6 @@ void gs_gui_conns_manager_window(bool *CONNS_manager, int access_level, bool all
 void gs_gui_config_manager_window(bool *CONFIG_manager, int access_level, bool allow_transmission, global_data_t *global)
 {
     ImGuiInputTextFlags_ flag = (ImGuiInputTextFlags_)0;
-    NetDataClient *network_data = global->network_data;
 
     static int XBAND_config_command = XBAND_INVALID_ID;
     // static cmd_input_t XBAND_command_input = {.mod = INVALID_ID, .cmd = XBAND_INVALID_ID, .unused = 0, .data_size = 0};
@@ -1947,17 +2119,13 @@ void gs_gui_config_manager_window(bool *CONFIG_manager, int access_level, bool a
             case XBAND_SET_TX:
             {
                 // gs_transmit(global_data->network_data, CS_TYPE_CONFIG_XBAND, CS_ENDPOINT_ROOFXBAND, &xband_config_data.TX, sizeof(xband_set_data_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&xband_config_data.TX, sizeof(xband_set_data_t), NetType::XBAND_CONFIG, NetVertex::ROOFXBAND);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                global->tx_engine->submit(xband_config_data.TX, NetType::XBAND_CONFIG, NetVertex::ROOFXBAND, TX_ORIGIN_CONFIG);
                 break;
             }
             case XBAND_SET_RX:
             {
                 // gs_transmit(global_data->network_data, CS_TYPE_CONFIG_XBAND, CS_ENDPOINT_HAYSTACK, &xband_config_data.RX, sizeof(xband_set_data_array_t));
-                NetFrame *network_frame = new NetFrame((unsigned char *)&xband_config_data.RX, sizeof(xband_set_data_array_t), NetType::XBAND_CONFIG, NetVertex::HAYSTACK);
-                network_frame->sendFrame(network_data);
-                delete network_frame;
+                global->tx_engine->submit(xband_config_data.RX, NetType::XBAND_CONFIG, NetVertex::HAYSTACK, TX_ORIGIN_CONFIG);
                 break;
             }
             case XBAND_SET_MAX_ON:
@@ -1965,14 +2133,14 @@ void gs_gui_config_manager_window(bool *CONFIG_manager, int access_level, bool a
             case XBAND_SET_TMP_OP:
             case XBAND_SET_LOOP_TIME:
             {
-                dbprintlf(RED_FG "Functionality not yet implemented.");
+                dbprintlf_err(LOG_MOD_GUI, RED_FG "Functionality not yet implemented.");
                 break;
             }
             case XBAND_DO_TX:
             case XBAND_DO_RX:
             case XBAND_DISABLE:
             {
-                dbprintlf(RED_FG "Functionality not available.");
+                dbprintlf_err(LOG_MOD_GUI, RED_FG "Functionality not available.");
                 break;
             }
             default:
@@ -1981,6 +2149,7 @@ void gs_gui_config_manager_window(bool *CONFIG_manager, int access_level, bool a
             }
             }
         }
+        gs_gui_tx_status(global, TX_ORIGIN_CONFIG);
 
         if (!allow_transmission)
         {
@@ -1995,42 +2164,226 @@ void gs_gui_config_manager_window(bool *CONFIG_manager, int access_level, bool a
     ImGui::End();
 }
 
-void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_display, global_data_t *global)
+// Sample loss as seen through the ct counter, shown under the CT / Mode graph.
+static void gs_gui_acs_upd_seq_stats(ACSRollingBuffer *acs_rolbuf, global_data_t *global)
+{
+    uint64_t expected = acs_rolbuf->samples + acs_rolbuf->missing;
+    ImGui::Text("Samples: %lu   Missing: %lu (%.1f%%)   Gaps: %lu   Longest: %d", (unsigned long)acs_rolbuf->samples, (unsigned long)acs_rolbuf->missing, expected > 0 ? 100.0 * acs_rolbuf->missing / expected : 0.0, (unsigned long)acs_rolbuf->gaps, acs_rolbuf->longest_gap);
+    ImGui::Text("Duplicates: %lu   Counter Restarts: %lu", (unsigned long)acs_rolbuf->duplicates, (unsigned long)acs_rolbuf->restarts);
+    if (global->settings->tooltips && ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Counted from jumps in the ct counter since the session began or the statistics were last reset. Gaps show as breaks in the graphs.");
+    }
+    if (acs_rolbuf->store.size() > 0)
+    {
+        TelemetryStore *store = &acs_rolbuf->store;
+        int newest = (store->offset() + store->size() - 1) % store->capacity();
+        ImGui::SameLine();
+        ImGui::Text("  Last Update: %.1f s ago", (lat_now_ns() - store->monoTimes()[newest]) / 1e9);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset Statistics"))
+    {
+        acs_rolbuf->resetStats();
+    }
+
+    if (acs_rolbuf->gapCount() > 0 && ImGui::TreeNode("Recent Gaps"))
+    {
+        ImGui::Columns(5, "acs_gaps");
+        ImGui::Separator();
+        ImGui::Text("Time (UTC)");
+        ImGui::NextColumn();
+        ImGui::Text("Span (s)");
+        ImGui::NextColumn();
+        ImGui::Text("CT Before");
+        ImGui::NextColumn();
+        ImGui::Text("CT After");
+        ImGui::NextColumn();
+        ImGui::Text("Missing");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < acs_rolbuf->gapCount(); i++)
+        {
+            const acs_gap_t *gap = acs_rolbuf->gap(i);
+            char stamp[16];
+            time_t secs = gap->t_utc / 1000000000ULL;
+            struct tm tm;
+            gmtime_r(&secs, &tm);
+            strftime(stamp, sizeof(stamp), "%H:%M:%S", &tm);
+            ImGui::Text("%s", stamp);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", gap->span);
+            ImGui::NextColumn();
+            ImGui::Text("%u", gap->ct_from);
+            ImGui::NextColumn();
+            ImGui::Text("%u", gap->ct_to);
+            ImGui::NextColumn();
+            if (gap->missing > 0)
+            {
+                ImGui::Text("%d", gap->missing);
+            }
+            else
+            {
+                ImGui::Text("RESTART");
+            }
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        ImGui::Separator();
+        ImGui::TreePop();
+    }
+}
+
+// The stretch of ACS history the graphs show, and the resolution it is drawn at.
+typedef struct
+{
+    double start; // UTC seconds.
+    double end;
+    int tier;     // TelemetryStore::pickTier(...)
+} acs_view_t;
+
+// One channel of the ACS store, as handed to the plot getters.
+typedef struct
+{
+    TelemetryStore *store;
+    int tier;
+    int ch;
+} acs_plot_src_t;
+
+static ImPlotPoint gs_gui_acs_plot_getter(void *data, int slot)
+{
+    acs_plot_src_t *src = (acs_plot_src_t *)data;
+    return ImPlotPoint(src->store->seconds(slot), src->store->column(src->ch)[slot]);
+}
+
+static ImPlotPoint gs_gui_acs_tier_mean(void *data, int slot)
+{
+    acs_plot_src_t *src = (acs_plot_src_t *)data;
+    return ImPlotPoint(src->store->tierSeconds(src->tier, slot), src->store->tier(src->tier)->mean[src->ch * TELEM_TIER_LEN + slot]);
+}
+
+static ImPlotPoint gs_gui_acs_tier_min(void *data, int slot)
+{
+    acs_plot_src_t *src = (acs_plot_src_t *)data;
+    return ImPlotPoint(src->store->tierSeconds(src->tier, slot), src->store->tier(src->tier)->min[src->ch * TELEM_TIER_LEN + slot]);
+}
+
+static ImPlotPoint gs_gui_acs_tier_max(void *data, int slot)
+{
+    acs_plot_src_t *src = (acs_plot_src_t *)data;
+    return ImPlotPoint(src->store->tierSeconds(src->tier, slot), src->store->tier(src->tier)->max[src->ch * TELEM_TIER_LEN + slot]);
+}
+
+// Plots one ACS channel against its UTC receive times, straight from the store: every row when the view is short enough, otherwise each bucket's mean inside a band from its minimum to its maximum.
+static void gs_gui_acs_plot_line(const char *label, ACSRollingBuffer *acs_rolbuf, int ch, const acs_view_t *view)
+{
+    acs_plot_src_t src = {&acs_rolbuf->store, view->tier, ch};
+
+    if (view->tier < 0)
+    {
+        ImPlot::PlotLineG(label, gs_gui_acs_plot_getter, &src, acs_rolbuf->store.size(), acs_rolbuf->store.offset());
+        return;
+    }
+
+    const telem_tier_t *tr = acs_rolbuf->store.tier(view->tier);
+    int offset = tr->count < TELEM_TIER_LEN ? 0 : tr->head;
+    ImPlot::PushStyleVar(ImPlotStyleVar_FillAlpha, 0.25f);
+    ImPlot::PlotShadedG(label, gs_gui_acs_tier_min, &src, gs_gui_acs_tier_max, &src, tr->count, offset);
+    ImPlot::PopStyleVar();
+    ImPlot::PlotLineG(label, gs_gui_acs_tier_mean, &src, tr->count, offset);
+}
+
+// Fits the Y axis of the next plot to two or three channels over the view, with one range query per channel.
+static void gs_gui_acs_limits(ACSRollingBuffer *acs_rolbuf, const acs_view_t *view, int ch0, int ch1, int ch2 = -1)
+{
+    const int chs[3] = {ch0, ch1, ch2};
+    float lo[3], hi[3];
+    int n = ch2 < 0 ? 2 : 3;
+    for (int i = 0; i < n; i++)
+    {
+        if (view->tier < 0)
+        {
+            acs_rolbuf->store.range(chs[i], view->start, view->end, &lo[i], &hi[i]);
+        }
+        else
+        {
+            acs_rolbuf->store.tierRange(view->tier, chs[i], view->start, view->end, &lo[i], &hi[i]);
+        }
+    }
+
+    if (n == 2)
+    {
+        ImPlot::SetNextPlotLimits(view->start, view->end, getMin(lo[0], lo[1]), getMax(hi[0], hi[1]), ImGuiCond_Always);
+    }
+    else
+    {
+        ImPlot::SetNextPlotLimits(view->start, view->end, getMin(lo[0], lo[1], lo[2]), getMax(hi[0], hi[1], hi[2]), ImGuiCond_Always);
+    }
+}
+
+// How far back the graphs reach; the resolution follows.
+static void gs_gui_acs_view_select(int *span, const acs_view_t *view, TelemetryStore *store)
 {
-    double start_time = acs_rolbuf->x_index - 60;
-    if (start_time < 0)
+    ImGui::SetNextItemWidth(120);
+    ImGui::Combo("History", span, "1 minute\0" "10 minutes\0" "1 hour\0" "6 hours\0" "24 hours\0\0");
+    ImGui::SameLine();
+    if (view->tier < 0)
     {
-        start_time = 0;
+        ImGui::Text("  Every sample");
     }
+    else
+    {
+        ImGui::Text("  %d s mean, min and max", (int)(store->tier(view->tier)->interval / 1000000000ULL));
+    }
+}
+
+// The ACS graphs share a UTC time axis.
+static bool gs_gui_acs_begin_plot(const char *title)
+{
+    return ImPlot::BeginPlot(title, "UTC", NULL, ImVec2(-1, 0), ImPlotFlags_None, ImPlotAxisFlags_Time);
+}
+
+void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_display, global_data_t *global)
+{
+    static int view_span = 0;
+    static const double view_seconds[] = {60, 600, 3600, 6 * 3600, 24 * 3600};
+
+    // Up to now, so the graphs keep scrolling when updates stop.
+    acs_view_t view;
+    view.end = lat_utc_ns() / 1e9;
+    view.start = view.end - view_seconds[view_span];
+    view.tier = acs_rolbuf->store.pickTier(view.start, view.end);
 
     if (global->settings->acs_multiple_windows)
     {
         if (ImGui::Begin("ACS Update: CT / Mode Graph", ACS_UPD_display))
         {
-            ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->mode.Min(), acs_rolbuf->ct.Min()), getMax(acs_rolbuf->mode.Max(), acs_rolbuf->ct.Max()), ImGuiCond_Always);
-            if (ImPlot::BeginPlot("CT / Mode Graph"))
+            gs_gui_acs_view_select(&view_span, &view, &acs_rolbuf->store);
+            gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_MODE, ACS_CH_CT);
+            if (gs_gui_acs_begin_plot("CT / Mode Graph"))
             {
 
-                ImPlot::PlotLine("CT", &acs_rolbuf->ct.data[0].x, &acs_rolbuf->ct.data[0].y, acs_rolbuf->ct.data.size(), acs_rolbuf->ct.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("CT", acs_rolbuf, ACS_CH_CT, &view);
 
-                ImPlot::PlotLine("Mode", &acs_rolbuf->mode.data[0].x, &acs_rolbuf->mode.data[0].y, acs_rolbuf->mode.data.size(), acs_rolbuf->mode.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("Mode", acs_rolbuf, ACS_CH_MODE, &view);
 
                 ImPlot::EndPlot();
             }
+            gs_gui_acs_upd_seq_stats(acs_rolbuf, global);
         }
         ImGui::End();
 
         if (ImGui::Begin("ACS Update: B (x, y, z) Graph", ACS_UPD_display))
         {
-            ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->bx.Min(), acs_rolbuf->by.Min(), acs_rolbuf->bz.Min()), getMax(acs_rolbuf->bx.Max(), acs_rolbuf->by.Max(), acs_rolbuf->bz.Max()), ImGuiCond_Always);
-            if (ImPlot::BeginPlot("B (x, y, z) Graph"))
+            gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_BX, ACS_CH_BY, ACS_CH_BZ);
+            if (gs_gui_acs_begin_plot("B (x, y, z) Graph"))
             {
 
-                ImPlot::PlotLine("x", &acs_rolbuf->bx.data[0].x, &acs_rolbuf->bx.data[0].y, acs_rolbuf->bx.data.size(), acs_rolbuf->bx.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("x", acs_rolbuf, ACS_CH_BX, &view);
 
-                ImPlot::PlotLine("y", &acs_rolbuf->by.data[0].x, &acs_rolbuf->by.data[0].y, acs_rolbuf->by.data.size(), acs_rolbuf->by.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("y", acs_rolbuf, ACS_CH_BY, &view);
 
-                ImPlot::PlotLine("z", &acs_rolbuf->bz.data[0].x, &acs_rolbuf->bz.data[0].y, acs_rolbuf->bz.data.size(), acs_rolbuf->bz.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("z", acs_rolbuf, ACS_CH_BZ, &view);
 
                 ImPlot::EndPlot();
             }
@@ -2039,15 +2392,15 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
 
         if (ImGui::Begin("ACS Update: W (x, y, z) Graph", ACS_UPD_display))
         {
-            ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->wx.Min(), acs_rolbuf->wy.Min(), acs_rolbuf->wz.Min()), getMax(acs_rolbuf->wx.Max(), acs_rolbuf->wy.Max(), acs_rolbuf->wz.Max()), ImGuiCond_Always);
-            if (ImPlot::BeginPlot("W (x, y, z) Graph"))
+            gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_WX, ACS_CH_WY, ACS_CH_WZ);
+            if (gs_gui_acs_begin_plot("W (x, y, z) Graph"))
             {
 
-                ImPlot::PlotLine("x", &acs_rolbuf->wx.data[0].x, &acs_rolbuf->wx.data[0].y, acs_rolbuf->wx.data.size(), acs_rolbuf->wx.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("x", acs_rolbuf, ACS_CH_WX, &view);
 
-                ImPlot::PlotLine("y", &acs_rolbuf->wy.data[0].x, &acs_rolbuf->wy.data[0].y, acs_rolbuf->wy.data.size(), acs_rolbuf->wy.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("y", acs_rolbuf, ACS_CH_WY, &view);
 
-                ImPlot::PlotLine("z", &acs_rolbuf->wz.data[0].x, &acs_rolbuf->wz.data[0].y, acs_rolbuf->wz.data.size(), acs_rolbuf->wz.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("z", acs_rolbuf, ACS_CH_WZ, &view);
 
                 ImPlot::EndPlot();
             }
@@ -2056,15 +2409,15 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
 
         if (ImGui::Begin("ACS Update: S (x, y, z) Graph", ACS_UPD_display))
         {
-            ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->sx.Min(), acs_rolbuf->sy.Min(), acs_rolbuf->sz.Min()), getMax(acs_rolbuf->sx.Max(), acs_rolbuf->sy.Max(), acs_rolbuf->sz.Max()), ImGuiCond_Always);
-            if (ImPlot::BeginPlot("S (x, y, z) Graph"))
+            gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_SX, ACS_CH_SY, ACS_CH_SZ);
+            if (gs_gui_acs_begin_plot("S (x, y, z) Graph"))
             {
 
-                ImPlot::PlotLine("x", &acs_rolbuf->sx.data[0].x, &acs_rolbuf->sx.data[0].y, acs_rolbuf->sx.data.size(), acs_rolbuf->sx.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("x", acs_rolbuf, ACS_CH_SX, &view);
 
-                ImPlot::PlotLine("y", &acs_rolbuf->sy.data[0].x, &acs_rolbuf->sy.data[0].y, acs_rolbuf->sy.data.size(), acs_rolbuf->sy.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("y", acs_rolbuf, ACS_CH_SY, &view);
 
-                ImPlot::PlotLine("z", &acs_rolbuf->sz.data[0].x, &acs_rolbuf->sz.data[0].y, acs_rolbuf->sz.data.size(), acs_rolbuf->sz.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("z", acs_rolbuf, ACS_CH_SZ, &view);
 
                 ImPlot::EndPlot();
             }
@@ -2073,13 +2426,13 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
 
         if (ImGui::Begin("ACS Update: Battery Graph", ACS_UPD_display))
         {
-            ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->vbatt.Min(), acs_rolbuf->vboost.Min()), getMax(acs_rolbuf->vbatt.Max(), acs_rolbuf->vbatt.Max()), ImGuiCond_Always);
-            if (ImPlot::BeginPlot("Battery Graph"))
+            gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_VBATT, ACS_CH_VBOOST);
+            if (gs_gui_acs_begin_plot("Battery Graph"))
             {
 
-                ImPlot::PlotLine("VBatt", &acs_rolbuf->vbatt.data[0].x, &acs_rolbuf->vbatt.data[0].y, acs_rolbuf->vbatt.data.size(), acs_rolbuf->vbatt.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("VBatt", acs_rolbuf, ACS_CH_VBATT, &view);
 
-                ImPlot::PlotLine("VBoost", &acs_rolbuf->vboost.data[0].x, &acs_rolbuf->vboost.data[0].y, acs_rolbuf->vboost.data.size(), acs_rolbuf->vboost.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("VBoost", acs_rolbuf, ACS_CH_VBOOST, &view);
 
                 ImPlot::EndPlot();
             }
@@ -2088,13 +2441,13 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
 
         if (ImGui::Begin("ACS Update: Solar Current Graph", ACS_UPD_display))
         {
-            ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->cursun.Min(), acs_rolbuf->cursun.Min()), getMax(acs_rolbuf->cursys.Max(), acs_rolbuf->cursys.Max()), ImGuiCond_Always);
-            if (ImPlot::BeginPlot("Solar Current Graph"))
+            gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_CURSUN, ACS_CH_CURSYS);
+            if (gs_gui_acs_begin_plot("Solar Current Graph"))
             {
 
-                ImPlot::PlotLine("CurSun", &acs_rolbuf->cursun.data[0].x, &acs_rolbuf->cursun.data[0].y, acs_rolbuf->cursun.data.size(), acs_rolbuf->cursun.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("CurSun", acs_rolbuf, ACS_CH_CURSUN, &view);
 
-                ImPlot::PlotLine("CurSys", &acs_rolbuf->cursys.data[0].x, &acs_rolbuf->cursys.data[0].y, acs_rolbuf->cursys.data.size(), acs_rolbuf->cursys.ofst, 2 * sizeof(float));
+                gs_gui_acs_plot_line("CurSys", acs_rolbuf, ACS_CH_CURSYS, &view);
 
                 ImPlot::EndPlot();
             }
@@ -2108,31 +2461,34 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
             // The implemented method of displaying the ACS update data includes a locally-global class (ACSDisplayData) with data that this window will display. The data is set by gs_receive.
             // NOTE: This window must be opened independent of ACS's automated data retrieval option.
 
+            gs_gui_acs_view_select(&view_span, &view, &acs_rolbuf->store);
+
             if (ImGui::CollapsingHeader("CT / Mode Graph", ImGuiTreeNodeFlags_DefaultOpen))
             {
-                ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->mode.Min(), acs_rolbuf->ct.Min()), getMax(acs_rolbuf->mode.Max(), acs_rolbuf->ct.Max()), ImGuiCond_Always);
-                if (ImPlot::BeginPlot("CT / Mode Graph"))
+                gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_MODE, ACS_CH_CT);
+                if (gs_gui_acs_begin_plot("CT / Mode Graph"))
                 {
 
-                    ImPlot::PlotLine("CT", &acs_rolbuf->ct.data[0].x, &acs_rolbuf->ct.data[0].y, acs_rolbuf->ct.data.size(), acs_rolbuf->ct.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("CT", acs_rolbuf, ACS_CH_CT, &view);
 
-                    ImPlot::PlotLine("Mode", &acs_rolbuf->mode.data[0].x, &acs_rolbuf->mode.data[0].y, acs_rolbuf->mode.data.size(), acs_rolbuf->mode.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("Mode", acs_rolbuf, ACS_CH_MODE, &view);
 
                     ImPlot::EndPlot();
                 }
+                gs_gui_acs_upd_seq_stats(acs_rolbuf, global);
             }
 
             if (ImGui::CollapsingHeader("B (x, y, z) Graph", ImGuiTreeNodeFlags_DefaultOpen))
             {
-                ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->bx.Min(), acs_rolbuf->by.Min(), acs_rolbuf->bz.Min()), getMax(acs_rolbuf->bx.Max(), acs_rolbuf->by.Max(), acs_rolbuf->bz.Max()), ImGuiCond_Always);
-                if (ImPlot::BeginPlot("B (x, y, z) Graph"))
+                gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_BX, ACS_CH_BY, ACS_CH_BZ);
+                if (gs_gui_acs_begin_plot("B (x, y, z) Graph"))
                 {
 
-                    ImPlot::PlotLine("x", &acs_rolbuf->bx.data[0].x, &acs_rolbuf->bx.data[0].y, acs_rolbuf->bx.data.size(), acs_rolbuf->bx.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("x", acs_rolbuf, ACS_CH_BX, &view);
 
-                    ImPlot::PlotLine("y", &acs_rolbuf->by.data[0].x, &acs_rolbuf->by.data[0].y, acs_rolbuf->by.data.size(), acs_rolbuf->by.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("y", acs_rolbuf, ACS_CH_BY, &view);
 
-                    ImPlot::PlotLine("z", &acs_rolbuf->bz.data[0].x, &acs_rolbuf->bz.data[0].y, acs_rolbuf->bz.data.size(), acs_rolbuf->bz.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("z", acs_rolbuf, ACS_CH_BZ, &view);
 
                     ImPlot::EndPlot();
                 }
@@ -2140,15 +2496,15 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
 
             if (ImGui::CollapsingHeader("W (x, y, z) Graph", ImGuiTreeNodeFlags_DefaultOpen))
             {
-                ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->wx.Min(), acs_rolbuf->wy.Min(), acs_rolbuf->wz.Min()), getMax(acs_rolbuf->wx.Max(), acs_rolbuf->wy.Max(), acs_rolbuf->wz.Max()), ImGuiCond_Always);
-                if (ImPlot::BeginPlot("W (x, y, z) Graph"))
+                gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_WX, ACS_CH_WY, ACS_CH_WZ);
+                if (gs_gui_acs_begin_plot("W (x, y, z) Graph"))
                 {
 
-                    ImPlot::PlotLine("x", &acs_rolbuf->wx.data[0].x, &acs_rolbuf->wx.data[0].y, acs_rolbuf->wx.data.size(), acs_rolbuf->wx.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("x", acs_rolbuf, ACS_CH_WX, &view);
 
-                    ImPlot::PlotLine("y", &acs_rolbuf->wy.data[0].x, &acs_rolbuf->wy.data[0].y, acs_rolbuf->wy.data.size(), acs_rolbuf->wy.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("y", acs_rolbuf, ACS_CH_WY, &view);
 
-                    ImPlot::PlotLine("z", &acs_rolbuf->wz.data[0].x, &acs_rolbuf->wz.data[0].y, acs_rolbuf->wz.data.size(), acs_rolbuf->wz.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("z", acs_rolbuf, ACS_CH_WZ, &view);
 
                     ImPlot::EndPlot();
                 }
@@ -2156,15 +2512,15 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
 
             if (ImGui::CollapsingHeader("S (x, y, z) Graph", ImGuiTreeNodeFlags_DefaultOpen))
             {
-                ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->sx.Min(), acs_rolbuf->sy.Min(), acs_rolbuf->sz.Min()), getMax(acs_rolbuf->sx.Max(), acs_rolbuf->sy.Max(), acs_rolbuf->sz.Max()), ImGuiCond_Always);
-                if (ImPlot::BeginPlot("S (x, y, z) Graph"))
+                gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_SX, ACS_CH_SY, ACS_CH_SZ);
+                if (gs_gui_acs_begin_plot("S (x, y, z) Graph"))
                 {
 
-                    ImPlot::PlotLine("x", &acs_rolbuf->sx.data[0].x, &acs_rolbuf->sx.data[0].y, acs_rolbuf->sx.data.size(), acs_rolbuf->sx.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("x", acs_rolbuf, ACS_CH_SX, &view);
 
-                    ImPlot::PlotLine("y", &acs_rolbuf->sy.data[0].x, &acs_rolbuf->sy.data[0].y, acs_rolbuf->sy.data.size(), acs_rolbuf->sy.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("y", acs_rolbuf, ACS_CH_SY, &view);
 
-                    ImPlot::PlotLine("z", &acs_rolbuf->sz.data[0].x, &acs_rolbuf->sz.data[0].y, acs_rolbuf->sz.data.size(), acs_rolbuf->sz.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("z", acs_rolbuf, ACS_CH_SZ, &view);
 
                     ImPlot::EndPlot();
                 }
@@ -2172,13 +2528,13 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
 
             if (ImGui::CollapsingHeader("Battery Graph", ImGuiTreeNodeFlags_DefaultOpen))
             {
-                ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->vbatt.Min(), acs_rolbuf->vboost.Min()), getMax(acs_rolbuf->vbatt.Max(), acs_rolbuf->vbatt.Max()), ImGuiCond_Always);
-                if (ImPlot::BeginPlot("Battery Graph"))
+                gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_VBATT, ACS_CH_VBOOST);
+                if (gs_gui_acs_begin_plot("Battery Graph"))
                 {
 
-                    ImPlot::PlotLine("VBatt", &acs_rolbuf->vbatt.data[0].x, &acs_rolbuf->vbatt.data[0].y, acs_rolbuf->vbatt.data.size(), acs_rolbuf->vbatt.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("VBatt", acs_rolbuf, ACS_CH_VBATT, &view);
 
-                    ImPlot::PlotLine("VBoost", &acs_rolbuf->vboost.data[0].x, &acs_rolbuf->vboost.data[0].y, acs_rolbuf->vboost.data.size(), acs_rolbuf->vboost.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("VBoost", acs_rolbuf, ACS_CH_VBOOST, &view);
 
                     ImPlot::EndPlot();
                 }
@@ -2186,13 +2542,13 @@ void gs_gui_acs_upd_display_window(ACSRollingBuffer *acs_rolbuf, bool *ACS_UPD_d
 
             if (ImGui::CollapsingHeader("Solar Current Graph", ImGuiTreeNodeFlags_DefaultOpen))
             {
-                ImPlot::SetNextPlotLimits(start_time, acs_rolbuf->x_index, getMin(acs_rolbuf->cursun.Min(), acs_rolbuf->cursun.Min()), getMax(acs_rolbuf->cursys.Max(), acs_rolbuf->cursys.Max()), ImGuiCond_Always);
-                if (ImPlot::BeginPlot("Solar Current Graph"))
+                gs_gui_acs_limits(acs_rolbuf, &view, ACS_CH_CURSUN, ACS_CH_CURSYS);
+                if (gs_gui_acs_begin_plot("Solar Current Graph"))
                 {
 
-                    ImPlot::PlotLine("CurSun", &acs_rolbuf->cursun.data[0].x, &acs_rolbuf->cursun.data[0].y, acs_rolbuf->cursun.data.size(), acs_rolbuf->cursun.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("CurSun", acs_rolbuf, ACS_CH_CURSUN, &view);
 
-                    ImPlot::PlotLine("CurSys", &acs_rolbuf->cursys.data[0].x, &acs_rolbuf->cursys.data[0].y, acs_rolbuf->cursys.data.size(), acs_rolbuf->cursys.ofst, 2 * sizeof(float));
+                    gs_gui_acs_plot_line("CurSys", acs_rolbuf, ACS_CH_CURSYS, &view);
 
                     ImPlot::EndPlot();
                 }
@@ -2423,4 +2779,413 @@ void gs_gui_user_manual_window(bool *User_Manual)
         ImGui::EndTabBar();
     }
     ImGui::End();
-}
\ No newline at end of file
+}
+void gs_gui_diagnostics_window(bool *DIAG_window, global_data_t *global)
+{
+    static char dump_filename[128] = "rx_latency.csv";
+    static int dump_status = 0;
+
+    if (ImGui::Begin("Diagnostics", DIAG_window, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        RxLatency *latency = global->rx_latency;
+
+        ImGui::Text("RECEIVE-PATH LATENCY (us)");
+        ImGui::Separator();
+        ImGui::Columns(7, "rx_latency_columns");
+        ImGui::Text("Stage");
+        ImGui::NextColumn();
+        ImGui::Text("Count");
+        ImGui::NextColumn();
+        ImGui::Text("Mean");
+        ImGui::NextColumn();
+        ImGui::Text("p50");
+        ImGui::NextColumn();
+        ImGui::Text("p99");
+        ImGui::NextColumn();
+        ImGui::Text("p99.9");
+        ImGui::NextColumn();
+        ImGui::Text("Max");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < RX_LAT_NUM; i++)
+        {
+            LatencyHistogram *hist = &latency->stage[i];
+
+            ImGui::Text("%s", RxLatency::stage_name(i));
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)hist->count());
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", hist->mean() / 1e3);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", hist->percentile(50) / 1e3);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", hist->percentile(99) / 1e3);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", hist->percentile(99.9) / 1e3);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", hist->max() / 1e3);
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        ImGui::Separator();
+        ImGui::Separator();
+
+        TxEngine *tx = global->tx_engine;
+
+        ImGui::Text("TRANSMIT");
+        ImGui::Separator();
+        ImGui::Text("Queued ----------- %lu", (unsigned long)tx->queued());
+        ImGui::Text("Submitted -------- %lu", (unsigned long)tx->submitted.load());
+        ImGui::Text("Rejected --------- %lu", (unsigned long)tx->rejected.load());
+        ImGui::Text("Sent ------------- %lu", (unsigned long)tx->sent.load());
+        ImGui::Text("Failed ----------- %lu", (unsigned long)tx->failed.load());
+        ImGui::Text("Bytes ------------ %lu", (unsigned long)tx->bytes.load());
+        ImGui::Text("Write Calls ------ %lu", (unsigned long)tx->writes.load());
+        ImGui::Text("Coalesced -------- %lu", (unsigned long)tx->coalesced.load());
+        ImGui::Text("Largest Batch ---- %lu", (unsigned long)tx->max_batch.load());
+        ImGui::Text("Events Lost ------ %lu", (unsigned long)tx->events_lost.load());
+        ImGui::Separator();
+        ImGui::Text("UHF LINK BUDGET");
+        int uhf_rate = tx->uhf.rate.load();
+        int uhf_burst = tx->uhf.burst.load();
+        if (ImGui::InputInt("Rate (B/s)", &uhf_rate, 10, 100) | ImGui::InputInt("Burst (B)", &uhf_burst, 8, 56))
+        {
+            tx->uhf.set(uhf_rate < 0 ? 0 : uhf_rate, uhf_burst < 1 ? 1 : uhf_burst);
+        }
+        if (ImGui::IsItemHovered() && global->settings->tooltips)
+        {
+            ImGui::SetTooltip("Payload bytes allowed onto the roof UHF uplink across all senders. A rate of zero disables the limit.");
+        }
+        ImGui::Text("Tokens ----------- %ld", (long)tx->uhf.level.load());
+        ImGui::Text("Throttled -------- %lu", (unsigned long)tx->throttled.load());
+        ImGui::Text("Safety Debt ------ %lu", (unsigned long)tx->uhf_debt.load());
+        ImGui::Separator();
+        ImGui::Columns(5, "tx_flow_columns");
+        ImGui::Text("Flow");
+        ImGui::NextColumn();
+        ImGui::Text("Class");
+        ImGui::NextColumn();
+        ImGui::Text("Weight");
+        ImGui::NextColumn();
+        ImGui::Text("Depth");
+        ImGui::NextColumn();
+        ImGui::Text("Sent");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < TX_FLOW_NUM; i++)
+        {
+            ImGui::Text("%s", TxEngine::flow_name(i));
+            ImGui::NextColumn();
+            ImGui::Text("%s", TxEngine::class_name(TxEngine::flow_class(i)));
+            ImGui::NextColumn();
+            int weight = tx->weight(i);
+            ImGui::PushID(i);
+            if (ImGui::SliderInt("##weight", &weight, 1, TX_WEIGHT_MAX))
+            {
+                tx->set_weight(i, weight);
+            }
+            ImGui::PopID();
+            ImGui::NextColumn();
+            ImGui::Text("%lu / %d", (unsigned long)tx->queued(i), TX_FLOW_LEN);
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)tx->flow_sent[i].load());
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        ImGui::Separator();
+        ImGui::Separator();
+
+        AcsPoller *poller = global->acs_poller;
+
+        ImGui::Text("ACS POLLER");
+        ImGui::Separator();
+        ImGui::Text("Polls ------------ %lu", (unsigned long)poller->polls.load());
+        ImGui::Text("Too Soon --------- %lu", (unsigned long)poller->too_soon.load());
+        ImGui::Text("Overruns --------- %lu", (unsigned long)poller->overruns.load());
+        ImGui::Text("Answered --------- %lu", (unsigned long)poller->answered.load());
+        ImGui::Text("Lost ------------- %lu", (unsigned long)poller->lost.load());
+        ImGui::Text("Backoffs --------- %lu", (unsigned long)poller->backoffs.load());
+        ImGui::Text("Lateness --------- p50 %.3f ms, p99 %.3f ms, max %.3f ms", poller->late.percentile(50) / 1e6, poller->late.percentile(99) / 1e6, poller->late.max() / 1e6);
+        ImGui::Separator();
+        ImGui::Separator();
+
+        ImGui::Text("ACS BUFFER");
+        ImGui::Separator();
+        ImGui::Text("Half Decode ------ %s", half_impl_name());
+        ImGui::Text("Foreign Writes --- %lu", (unsigned long)global->acs_rolbuf->foreign_writes.load());
+        ImGui::Separator();
+        ImGui::Separator();
+
+        CmdTracker *tracker = global->cmd_tracker;
+
+        ImGui::Text("COMMAND ROUND TRIP (ms)");
+        ImGui::Separator();
+        ImGui::Columns(10, "cmd_rtt_columns");
+        ImGui::Text("Module");
+        ImGui::NextColumn();
+        ImGui::Text("Command");
+        ImGui::NextColumn();
+        ImGui::Text("Sent");
+        ImGui::NextColumn();
+        ImGui::Text("Answered");
+        ImGui::NextColumn();
+        ImGui::Text("Timed Out");
+        ImGui::NextColumn();
+        ImGui::Text("Unmatched");
+        ImGui::NextColumn();
+        ImGui::Text("Not Sent");
+        ImGui::NextColumn();
+        ImGui::Text("p50");
+        ImGui::NextColumn();
+        ImGui::Text("p99");
+        ImGui::NextColumn();
+        ImGui::Text("Max");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < tracker->stats_count(); i++)
+        {
+            const cmd_stats_t *stat = tracker->stats(i);
+
+            ImGui::Text("0x%02x", stat->mod);
+            ImGui::NextColumn();
+            ImGui::Text("0x%02x", stat->cmd);
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)stat->sent);
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)stat->answered);
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)stat->timed_out);
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)stat->unmatched);
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)stat->not_sent);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", stat->rtt->percentile(50) / 1e6);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", stat->rtt->percentile(99) / 1e6);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", stat->rtt->max() / 1e6);
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        if (ImGui::Button("Reset Round Trip"))
+        {
+            tracker->reset_stats();
+        }
+        ImGui::Separator();
+        ImGui::Separator();
+
+        RxMsgQueue *queue = global->rx_queue;
+
+        ImGui::Text("RECEIVE-TO-GUI QUEUES");
+        ImGui::Separator();
+        ImGui::Columns(7, "rx_queue_columns");
+        ImGui::Text("Class");
+        ImGui::NextColumn();
+        ImGui::Text("Policy");
+        ImGui::NextColumn();
+        ImGui::Text("Depth");
+        ImGui::NextColumn();
+        ImGui::Text("High Water");
+        ImGui::NextColumn();
+        ImGui::Text("Queued");
+        ImGui::NextColumn();
+        ImGui::Text("Dropped");
+        ImGui::NextColumn();
+        ImGui::Text("Blocked");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < RX_CLASS_NUM; i++)
+        {
+            ImGui::Text("%s", RxMsgQueue::class_name(i));
+            ImGui::NextColumn();
+            int policy = queue->policy[i].load();
+            ImGui::PushID(i);
+            if (ImGui::BeginCombo("##policy", RxMsgQueue::policy_name(policy)))
+            {
+                for (int p = RX_POLICY_DROP_OLDEST; p <= RX_POLICY_BLOCK; p++)
+                {
+                    if (ImGui::Selectable(RxMsgQueue::policy_name(p), p == policy))
+                    {
+                        queue->policy[i] = p;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            ImGui::PopID();
+            ImGui::NextColumn();
+            ImGui::Text("%lu / %lu", (unsigned long)queue->size(i), (unsigned long)queue->capacity());
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)queue->high_water[i].load());
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)queue->queued[i].load());
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)queue->dropped[i].load());
+            ImGui::NextColumn();
+            ImGui::Text("%lu", (unsigned long)queue->blocked[i].load());
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        ImGui::Separator();
+
+        if (ImGui::Button("Reset Latency"))
+        {
+            latency->reset();
+            dump_status = 0;
+        }
+        if (ImGui::IsItemHovered() && global->settings->tooltips)
+        {
+            ImGui::SetTooltip("Clear all latency samples, e.g. at the start of a pass.");
+        }
+
+        ImGui::InputText("##dump_filename", dump_filename, sizeof(dump_filename));
+        ImGui::SameLine();
+        if (ImGui::Button("Dump to File"))
+        {
+            dump_status = latency->dump(dump_filename);
+        }
+        if (dump_status > 0)
+        {
+            ImGui::Text("Wrote %s.", dump_filename);
+        }
+        else if (dump_status < 0)
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Could not write %s.", dump_filename);
+        }
+    }
+    ImGui::End();
+}
+
+void gs_gui_sched_window(bool *SCHED_window, int access_level, bool allow_transmission, global_data_t *global)
+{
+    static char sched_filename[128] = "schedule.txt";
+    static char sched_error[128] = "";
+    static int load_status = 0;
+
+    if (ImGui::Begin("Command Scheduler", SCHED_window, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        CmdScheduler *sched = global->cmd_sched;
+        bool armed = sched->armed();
+
+        ImGui::InputText("##sched_filename", sched_filename, sizeof(sched_filename));
+        ImGui::SameLine();
+        if (ImGui::Button("Load") && !armed)
+        {
+            load_status = sched->load(sched_filename, sched_error, sizeof(sched_error));
+        }
+        if (ImGui::IsItemHovered() && global->settings->tooltips)
+        {
+            ImGui::SetTooltip("One command per line: <UTC time or +seconds> <module> <command> [data bytes in hex].");
+        }
+        if (load_status > 0)
+        {
+            ImGui::Text("Loaded %d commands.", load_status);
+        }
+        else if (load_status < 0)
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", sched_error);
+        }
+
+        // Stopping a schedule is always allowed; only arming one is restricted.
+        if (armed)
+        {
+            if (ImGui::Button("Cancel"))
+            {
+                sched->cancel();
+            }
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "ARMED");
+        }
+        else if (access_level < sched->required_access())
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "ACCESS DENIED (LEVEL %d REQUIRED)", sched->required_access());
+        }
+        else if (!allow_transmission)
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "TRANSMISSIONS LOCKED");
+        }
+        else if (ImGui::Button("Arm") && sched->count() > 0)
+        {
+            sched->arm();
+        }
+
+        ImGui::Text("Released --------- %lu", (unsigned long)sched->released.load());
+        ImGui::Text("Skipped ---------- %lu", (unsigned long)sched->skipped.load());
+        ImGui::Text("Release Jitter --- p50 %.3f ms, p99 %.3f ms, max %.3f ms", sched->jitter.percentile(50) / 1e6, sched->jitter.percentile(99) / 1e6, sched->jitter.max() / 1e6);
+        ImGui::Separator();
+
+        uint64_t now = sched_utc_ns();
+
+        ImGui::Columns(8, "sched_columns");
+        ImGui::Text("Time (UTC)");
+        ImGui::NextColumn();
+        ImGui::Text("Module");
+        ImGui::NextColumn();
+        ImGui::Text("Command");
+        ImGui::NextColumn();
+        ImGui::Text("State");
+        ImGui::NextColumn();
+        ImGui::Text("Late (ms)");
+        ImGui::NextColumn();
+        ImGui::Text("Reply");
+        ImGui::NextColumn();
+        ImGui::Text("Return Value");
+        ImGui::NextColumn();
+        ImGui::Text("RTT (ms)");
+        ImGui::NextColumn();
+        ImGui::Separator();
+        for (int i = 0; i < sched->count(); i++)
+        {
+            sched_entry_t *entry = sched->entry(i);
+            int state = entry->state.load(std::memory_order_acquire);
+
+            if (entry->relative && !armed && state == SCHED_STATE_WAITING)
+            {
+                ImGui::Text("+%.3f s", entry->t_offset / 1e9);
+            }
+            else
+            {
+                char stamp[32];
+                time_t secs = entry->t_sched / 1000000000ULL;
+                struct tm tm;
+                gmtime_r(&secs, &tm);
+                strftime(stamp, sizeof(stamp), "%H:%M:%S", &tm);
+                ImGui::Text("%s.%03d", stamp, (int)((entry->t_sched / 1000000ULL) % 1000));
+                if (state == SCHED_STATE_WAITING && entry->t_sched > now)
+                {
+                    ImGui::SameLine();
+                    ImGui::Text("(T-%.1f s)", (entry->t_sched - now) / 1e9);
+                }
+            }
+            ImGui::NextColumn();
+            ImGui::Text("0x%02x", entry->mod);
+            ImGui::NextColumn();
+            ImGui::Text("0x%02x", entry->cmd);
+            ImGui::NextColumn();
+            ImGui::Text("%s", CmdScheduler::state_name(state));
+            ImGui::NextColumn();
+            if (state == SCHED_STATE_RELEASED)
+            {
+                ImGui::Text("%.3f", (entry->t_release - entry->t_sched) / 1e6);
+            }
+            ImGui::NextColumn();
+            if (entry->result >= 0)
+            {
+                ImGui::Text("%s", CmdTracker::status_name(entry->result));
+            }
+            ImGui::NextColumn();
+            if (entry->result == CMD_STATUS_ANSWERED)
+            {
+                ImGui::Text("%d", entry->retval);
+            }
+            ImGui::NextColumn();
+            if (entry->result == CMD_STATUS_ANSWERED)
+            {
+                ImGui::Text("%.1f", entry->rtt / 1e6);
+            }
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+    ImGui::End();
+}
@@ -33,9 +33,13 @@
 #include "backend/imgui_impl_opengl2.h"
 #include "gs.hpp"
 #include "gs_gui.hpp"
+#include "gs_log.hpp"
 
 int main(int, char **)
 {
+    // Hot-path logging is formatted and written by a background thread.
+    gs_log_start(stderr);
+
     ////////// INIT ///////////
     // Setup the window.
     glfwSetErrorCallback(glfw_error_callback);
@@ -85,6 +89,17 @@ int main(int, char **)
 
     global_data_t global[1] = {0};
     global->acs_rolbuf = new ACSRollingBuffer();
+    global->rx_pool = new RxFramePool();
+    global->rx_stream = new RxStream(global->rx_pool);
+    global->rx_engine = new RxEngine();
+    global->rx_dispatcher = new RxDispatcher();
+    global->rx_latency = new RxLatency();
+    global->tx_engine = new TxEngine();
+    global->cmd_tracker = new CmdTracker();
+    global->cmd_sched = new CmdScheduler(global->tx_engine);
+    global->acs_poller = new AcsPoller(global->tx_engine);
+    global->rx_queue = new RxMsgQueue();
+    gs_rx_register_handlers(global);
     global->network_data = new NetDataClient(NetPort::CLIENT, SERVER_POLL_RATE);
     global->network_data->recv_active = true;
     global->last_contact = -1.0;
@@ -105,11 +120,15 @@ int main(int, char **)
     bool DISP_control_panel = true;
     bool CONNS_manager = true;
     bool User_Manual = false;
+    bool DIAG_window = false;
+    bool SCHED_window = false;
 
     // Set-up and start the RX thread.
-    pthread_t rx_thread_id, polling_thread_id;
+    pthread_t rx_thread_id, tx_thread_id, keepalive_thread_id;
     pthread_create(&rx_thread_id, NULL, gs_rx_thread, global);
-    pthread_create(&polling_thread_id, NULL, gs_polling_thread, global->network_data);
+    pthread_create(&tx_thread_id, NULL, gs_tx_thread, global);
+    // The network library's gs_polling_thread(...) would write POLLs to the socket behind the TX thread's back.
+    pthread_create(&keepalive_thread_id, NULL, gs_keepalive_thread, global);
 
     // Start the receiver thread, passing it our acs_rolbuf (where we will read ACS Update data from) and (perhaps a cmd_output_t for all other data?).
 
@@ -124,6 +143,17 @@ int main(int, char **)
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
+        // Pick up everything the RX thread decoded since the last frame.
+        gs_rx_drain(global);
+        global->tx_engine->drain_events(global->cmd_tracker);
+        global->cmd_sched->collect(global->cmd_tracker);
+        // Whether or not its window is open, an armed schedule stops the moment its commands could no longer be sent by hand.
+        if (global->cmd_sched->armed() && (!allow_transmission || auth.access_level < global->cmd_sched->required_access()))
+        {
+            global->cmd_sched->cancel();
+        }
+        global->cmd_tracker->expire(lat_now_ns());
+
         // Level 0: Basic access, can retrieve data from acs_upd.
         // Level 1: Team Member access, can execute Data-down commands.
         // Level 2: Priority access, can set some values.
@@ -145,7 +175,7 @@ int main(int, char **)
 
         if (EPS_window)
         {
-            gs_gui_eps_window(global->network_data, &ACS_window, auth.access_level, allow_transmission);
+            gs_gui_eps_window(global, &EPS_window, auth.access_level, allow_transmission);
         }
 
         if (XBAND_window)
@@ -166,7 +196,7 @@ int main(int, char **)
         // SYS_CLEAN_SHBYTES = 0xfd
         if (SYS_CTRL_window)
         {
-            gs_gui_sys_ctrl_window(global->network_data, &SYS_CTRL_window, auth.access_level, allow_transmission);
+            gs_gui_sys_ctrl_window(global, &SYS_CTRL_window, auth.access_level, allow_transmission);
         }
 
         if (RX_display)
@@ -201,6 +231,16 @@ int main(int, char **)
             gs_gui_user_manual_window(&User_Manual);
         }
 
+        if (DIAG_window)
+        {
+            gs_gui_diagnostics_window(&DIAG_window, global);
+        }
+
+        if (SCHED_window)
+        {
+            gs_gui_sched_window(&SCHED_window, auth.access_level, allow_transmission, global);
+        }
+
         // The main menu bar located at the top of the screen.
         if (ImGui::BeginMainMenuBar())
         {
@@ -279,6 +319,28 @@ int main(int, char **)
                 ImGui::EndTooltip();
             }
 
+            if (ImGui::Button("Scheduler"))
+            {
+                SCHED_window = !SCHED_window;
+            }
+            if (ImGui::IsItemHovered() && global->settings->tooltips)
+            {
+                ImGui::BeginTooltip();
+                ImGui::SetTooltip("Toggle Command Scheduler visibility.");
+                ImGui::EndTooltip();
+            }
+
+            if (ImGui::Button("Diagnostics"))
+            {
+                DIAG_window = !DIAG_window;
+            }
+            if (ImGui::IsItemHovered() && global->settings->tooltips)
+            {
+                ImGui::BeginTooltip();
+                ImGui::SetTooltip("Toggle Diagnostics visibility.");
+                ImGui::EndTooltip();
+            }
+
             if (ImGui::Button("User Manual"))
             {
                 User_Manual = !User_Manual;
@@ -335,18 +397,35 @@ int main(int, char **)
 
         glfwMakeContextCurrent(window);
         glfwSwapBuffers(window);
+        global->rx_latency->rendered();
     }
 
     // Finished.
     void *retval;
-    pthread_cancel(rx_thread_id);
-    pthread_cancel(polling_thread_id);
+    global->network_data->recv_active = false;
+    global->rx_queue->close();
+    global->rx_engine->wake();
     pthread_join(rx_thread_id, &retval);
-    retval == PTHREAD_CANCELED ? printf("Good rx_thread_id join.\n") : printf("Bad rx_thread_id join.\n");
-    pthread_join(polling_thread_id, &retval);
-    retval == PTHREAD_CANCELED ? printf("Good polling_thread_id join.\n") : printf("Bad polling_thread_id join.\n");
+    retval == NULL ? printf("Good rx_thread_id join.\n") : printf("Bad rx_thread_id join.\n");
+    global->cmd_sched->cancel();
+    global->acs_poller->stop();
+    global->tx_engine->stop();
+    pthread_join(tx_thread_id, &retval);
+    retval == NULL ? printf("Good tx_thread_id join.\n") : printf("Bad tx_thread_id join.\n");
+    pthread_join(keepalive_thread_id, &retval);
+    retval == NULL ? printf("Good keepalive_thread_id join.\n") : printf("Bad keepalive_thread_id join.\n");
     close(global->network_data->socket);
     delete global->acs_rolbuf;
+    delete global->rx_stream;
+    delete global->rx_pool;
+    delete global->rx_engine;
+    delete global->rx_dispatcher;
+    delete global->rx_latency;
+    delete global->cmd_sched;
+    delete global->acs_poller;
+    delete global->tx_engine;
+    delete global->cmd_tracker;
+    delete global->rx_queue;
     delete global->network_data;
 
     // Cleanup.
@@ -357,5 +436,7 @@ int main(int, char **)
     glfwDestroyWindow(window);
     glfwTerminate();
 
+    gs_log_stop();
+
     return 1;
 }
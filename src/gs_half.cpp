@@ -0,0 +1,79 @@
+/**
+ * @file gs_half.cpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief IEEE 754 half-precision to single-precision conversion.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.30
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "gs_half.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HALF_HAVE_F16C_PATH
+#endif
+
+static void half_to_float_n_scalar(const uint16_t *in, float *out, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        out[i] = half_to_float(in[i]);
+    }
+}
+
+#ifdef HALF_HAVE_F16C_PATH
+// Built for F16C regardless of the compiler flags; only called once the CPU is known to have it.
+__attribute__((target("avx,f16c"))) static void half_to_float_n_f16c(const uint16_t *in, float *out, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i h = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+    for (; i < n; i++)
+    {
+        out[i] = half_to_float(in[i]);
+    }
+}
+#endif
+
+typedef void (*half_conv_t)(const uint16_t *, float *, int);
+
+static half_conv_t half_select()
+{
+#ifdef HALF_HAVE_F16C_PATH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c"))
+    {
+        return half_to_float_n_f16c;
+    }
+#endif
+    return half_to_float_n_scalar;
+}
+
+static half_conv_t half_conv()
+{
+    static half_conv_t conv = half_select();
+    return conv;
+}
+
+void half_to_float_n(const uint16_t *in, float *out, int n)
+{
+    half_conv()(in, out, n);
+}
+
+const char *half_impl_name()
+{
+#ifdef HALF_HAVE_F16C_PATH
+    if (half_conv() == half_to_float_n_f16c)
+    {
+        return "F16C";
+    }
+#endif
+    return "Scalar";
+}
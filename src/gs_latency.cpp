@@ -0,0 +1,227 @@
+/**
+ * @file gs_latency.cpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Latency histograms for the receive path.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.26
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "gs_latency.hpp"
+#include "meb_debug.hpp"
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+int LatencyHistogram::index(uint64_t ns)
+{
+    if (ns < LAT_SUB_COUNT)
+    {
+        return (int)ns;
+    }
+
+    int msb = 63 - __builtin_clzll(ns);
+    if (msb >= LAT_MAX_BITS)
+    {
+        return LAT_BUCKETS - 1;
+    }
+
+    int group = msb - LAT_SUB_BITS + 1;
+    int sub = (int)(ns >> (msb - LAT_SUB_BITS)) - LAT_SUB_COUNT;
+    return group * LAT_SUB_COUNT + sub;
+}
+
+uint64_t LatencyHistogram::lower(int idx)
+{
+    if (idx < LAT_SUB_COUNT)
+    {
+        return idx;
+    }
+
+    int group = idx / LAT_SUB_COUNT;
+    int sub = idx % LAT_SUB_COUNT;
+    return (uint64_t)(LAT_SUB_COUNT + sub) << (group - 1);
+}
+
+void LatencyHistogram::record(uint64_t ns)
+{
+    buckets[index(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > largest.load(std::memory_order_relaxed))
+    {
+        largest.store(ns, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double percentile)
+{
+    uint64_t n = 0;
+    uint64_t counts[LAT_BUCKETS];
+    for (int i = 0; i < LAT_BUCKETS; i++)
+    {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        n += counts[i];
+    }
+
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)(percentile / 100.0 * n + 0.5);
+    if (target < 1)
+    {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LAT_BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= target)
+        {
+            // Report the highest value equivalent to this bucket, but never more than the largest sample seen.
+            uint64_t upper = i + 1 < LAT_BUCKETS ? lower(i + 1) - 1 : lower(i);
+            uint64_t top = largest.load(std::memory_order_relaxed);
+            return upper < top ? upper : top;
+        }
+    }
+
+    return largest.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < LAT_BUCKETS; i++)
+    {
+        buckets[i] = 0;
+    }
+    total = 0;
+    sum = 0;
+    largest = 0;
+}
+
+void LatencyHistogram::dump(FILE *fp)
+{
+    for (int i = 0; i < LAT_BUCKETS; i++)
+    {
+        uint64_t ct = buckets[i].load(std::memory_order_relaxed);
+        if (ct > 0)
+        {
+            uint64_t upper = i + 1 < LAT_BUCKETS ? lower(i + 1) - 1 : UINT64_MAX;
+            fprintf(fp, "%lu,%lu,%lu\n", (unsigned long)lower(i), (unsigned long)upper, (unsigned long)ct);
+        }
+    }
+}
+
+uint64_t LatencyHistogram::count()
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::max()
+{
+    return largest.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean()
+{
+    uint64_t n = total.load(std::memory_order_relaxed);
+    return n > 0 ? (double)sum.load(std::memory_order_relaxed) / n : 0.0;
+}
+
+RxLatency::RxLatency()
+{
+    cur_ready = 0;
+    cur_parsed = 0;
+    num_pending = 0;
+}
+
+void RxLatency::drained(uint64_t t_ready, uint64_t t_handled)
+{
+    if (t_ready == 0 || num_pending >= LAT_PENDING_MAX)
+    {
+        return;
+    }
+    pending_ready[num_pending] = t_ready;
+    pending_handled[num_pending] = t_handled;
+    num_pending++;
+}
+
+void RxLatency::rendered()
+{
+    if (num_pending == 0)
+    {
+        return;
+    }
+
+    uint64_t now = lat_now_ns();
+    for (int i = 0; i < num_pending; i++)
+    {
+        stage[RX_LAT_RENDER].record(now - pending_handled[i]);
+        stage[RX_LAT_TOTAL].record(now - pending_ready[i]);
+    }
+    num_pending = 0;
+}
+
+void RxLatency::reset()
+{
+    for (int i = 0; i < RX_LAT_NUM; i++)
+    {
+        stage[i].reset();
+    }
+}
+
+const char *RxLatency::stage_name(int stage)
+{
+    switch (stage)
+    {
+    case RX_LAT_PARSE:
+        return "Ready -> Parsed";
+    case RX_LAT_HANDLE:
+        return "Parsed -> Handled";
+    case RX_LAT_RENDER:
+        return "Handled -> Rendered";
+    case RX_LAT_TOTAL:
+        return "Ready -> Rendered";
+    default:
+        return "Unknown";
+    }
+}
+
+int RxLatency::dump(const char *filename)
+{
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL)
+    {
+        dbprintlf_err(LOG_MOD_GEN, RED_FG "Could not open %s for writing.", filename);
+        erprintlf(errno);
+        return -1;
+    }
+
+    fprintf(fp, "# Receive-path latency, nanoseconds.\n");
+    fprintf(fp, "# stage,count,mean,p50,p90,p99,p99.9,max\n");
+    for (int i = 0; i < RX_LAT_NUM; i++)
+    {
+        fprintf(fp, "%s,%lu,%.0f,%lu,%lu,%lu,%lu,%lu\n", stage_name(i), (unsigned long)stage[i].count(), stage[i].mean(),
+                (unsigned long)stage[i].percentile(50), (unsigned long)stage[i].percentile(90), (unsigned long)stage[i].percentile(99),
+                (unsigned long)stage[i].percentile(99.9), (unsigned long)stage[i].max());
+    }
+
+    for (int i = 0; i < RX_LAT_NUM; i++)
+    {
+        fprintf(fp, "\n# %s: lower,upper,count\n", stage_name(i));
+        stage[i].dump(fp);
+    }
+
+    fclose(fp);
+    return 1;
+}
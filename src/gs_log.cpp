@@ -0,0 +1,220 @@
+/**
+ * @file gs_log.cpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Asynchronous binary logger for hot paths.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.25
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include <unistd.h>
+#include <pthread.h>
+#include <atomic>
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+/**
+ * @brief Per-thread record ring. The owning thread produces, the writer thread consumes.
+ *
+ */
+typedef struct gs_log_ring_t
+{
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    std::atomic<bool> retired; // Owning thread has exited; free once drained.
+    struct gs_log_ring_t *next;
+    gs_log_rec_t recs[GS_LOG_RING_LEN];
+} gs_log_ring_t;
+
+static pthread_mutex_t gs_log_rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static gs_log_ring_t *gs_log_rings = NULL;
+
+static std::atomic<uint64_t> gs_log_written_ct(0);
+static std::atomic<uint64_t> gs_log_dropped_ct(0);
+
+static std::atomic<bool> gs_log_running(false);
+static pthread_t gs_log_writer_tid;
+static FILE *gs_log_fp = NULL;
+
+/**
+ * @brief Registers the calling thread's ring on first use and retires it at thread exit.
+ *
+ */
+class GsLogThreadRing
+{
+public:
+    GsLogThreadRing() : ring(NULL) {}
+
+    ~GsLogThreadRing()
+    {
+        if (ring != NULL)
+        {
+            ring->retired = true;
+        }
+    }
+
+    gs_log_ring_t *get()
+    {
+        if (ring == NULL)
+        {
+            ring = new gs_log_ring_t;
+            ring->head = 0;
+            ring->tail = 0;
+            ring->retired = false;
+
+            pthread_mutex_lock(&gs_log_rings_lock);
+            ring->next = gs_log_rings;
+            gs_log_rings = ring;
+            pthread_mutex_unlock(&gs_log_rings_lock);
+        }
+        return ring;
+    }
+
+private:
+    gs_log_ring_t *ring;
+};
+
+static thread_local GsLogThreadRing gs_log_thread_ring;
+
+gs_log_rec_t *gs_log_reserve()
+{
+    gs_log_ring_t *ring = gs_log_thread_ring.get();
+
+    size_t t = ring->tail.load(std::memory_order_relaxed);
+    if (t - ring->head.load(std::memory_order_acquire) >= GS_LOG_RING_LEN)
+    {
+        gs_log_dropped_ct++;
+        return NULL;
+    }
+
+    return &ring->recs[t & (GS_LOG_RING_LEN - 1)];
+}
+
+void gs_log_commit()
+{
+    gs_log_ring_t *ring = gs_log_thread_ring.get();
+    ring->tail.store(ring->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    gs_log_written_ct++;
+}
+
+uint64_t gs_log_written()
+{
+    return gs_log_written_ct.load();
+}
+
+uint64_t gs_log_dropped()
+{
+    return gs_log_dropped_ct.load();
+}
+
+/**
+ * @brief Formats and prints every record currently in one ring.
+ *
+ * @return int Number of records printed.
+ */
+static int gs_log_drain_ring(gs_log_ring_t *ring, FILE *fp)
+{
+    int count = 0;
+    size_t h = ring->head.load(std::memory_order_relaxed);
+    size_t t = ring->tail.load(std::memory_order_acquire);
+
+    for (; h != t; h++, count++)
+    {
+        const gs_log_rec_t *rec = &ring->recs[h & (GS_LOG_RING_LEN - 1)];
+        fprintf(fp, "[%s:%d | %s] ", rec->file, rec->line, rec->func);
+        rec->emit(rec, fp);
+        if (rec->truncated)
+        {
+            fprintf(fp, "(arguments truncated)\n");
+        }
+    }
+
+    ring->head.store(h, std::memory_order_release);
+    return count;
+}
+
+/**
+ * @brief Drains all rings once, freeing rings whose threads have exited.
+ *
+ * @return int Number of records printed.
+ */
+static int gs_log_drain_all(FILE *fp)
+{
+    int count = 0;
+
+    pthread_mutex_lock(&gs_log_rings_lock);
+    gs_log_ring_t **link = &gs_log_rings;
+    while (*link != NULL)
+    {
+        gs_log_ring_t *ring = *link;
+        // Read retired before draining so nothing committed before retirement is missed.
+        bool retired = ring->retired.load(std::memory_order_acquire);
+        count += gs_log_drain_ring(ring, fp);
+
+        if (retired)
+        {
+            *link = ring->next;
+            delete ring;
+        }
+        else
+        {
+            link = &ring->next;
+        }
+    }
+    pthread_mutex_unlock(&gs_log_rings_lock);
+
+    if (count > 0)
+    {
+        fflush(fp);
+    }
+
+    return count;
+}
+
+static void *gs_log_writer_thread(void *args)
+{
+    while (gs_log_running)
+    {
+        if (gs_log_drain_all(gs_log_fp) == 0)
+        {
+            usleep(GS_LOG_IDLE_SLEEP);
+        }
+    }
+
+    gs_log_drain_all(gs_log_fp);
+    return NULL;
+}
+
+int gs_log_start(FILE *fp)
+{
+    if (gs_log_running)
+    {
+        return 1;
+    }
+
+    gs_log_fp = fp;
+    gs_log_running = true;
+
+    if (pthread_create(&gs_log_writer_tid, NULL, gs_log_writer_thread, NULL) != 0)
+    {
+        gs_log_running = false;
+        dbprintlf(RED_FG "Failed to start log writer thread.");
+        return -1;
+    }
+
+    return 1;
+}
+
+void gs_log_stop()
+{
+    if (!gs_log_running)
+    {
+        return;
+    }
+
+    gs_log_running = false;
+    pthread_join(gs_log_writer_tid, NULL);
+}
@@ -0,0 +1,532 @@
+/**
+ * @file gs_rx.cpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Receive-path infrastructure used by gs_rx_thread.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include "network.hpp"
+#include "gs_rx.hpp"
+#include "meb_debug.hpp"
+#include "gs_log.hpp"
+
+RxFramePool::RxFramePool() : acquired(0), released(0), exhausted(0), heap_allocs(0)
+{
+    memset(frames, 0x0, sizeof(frames));
+    for (int i = 0; i < RX_POOL_SIZE; i++)
+    {
+        free_list[i] = &frames[i];
+    }
+    free_top = RX_POOL_SIZE;
+}
+
+RxFramePool::~RxFramePool()
+{
+}
+
+rx_frame_t *RxFramePool::acquire()
+{
+    acquired++;
+
+    if (free_top > 0)
+    {
+        return free_list[--free_top];
+    }
+
+    // Pool is exhausted; should never happen in steady state since the RX thread holds one frame at a time.
+    exhausted++;
+    heap_allocs++;
+    return new rx_frame_t;
+}
+
+void RxFramePool::release(rx_frame_t *frame)
+{
+    if (frame == NULL)
+    {
+        return;
+    }
+
+    released++;
+
+    if (frame < &frames[0] || frame >= &frames[RX_POOL_SIZE])
+    {
+        delete frame;
+        return;
+    }
+
+    free_list[free_top++] = frame;
+}
+
+RxEngine::RxEngine()
+{
+    watched = -1;
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (epfd < 0 || wakefd < 0 || timerfd < 0)
+    {
+        dbprintlf_err(LOG_MOD_RX, FATAL "Failed to create RX engine descriptors.");
+        erprintlf(errno);
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0x0, sizeof(ev));
+
+    ev.events = EPOLLIN;
+    ev.data.fd = wakefd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+
+    ev.events = EPOLLIN;
+    ev.data.fd = timerfd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, timerfd, &ev);
+}
+
+RxEngine::~RxEngine()
+{
+    if (timerfd >= 0)
+    {
+        close(timerfd);
+    }
+    if (wakefd >= 0)
+    {
+        close(wakefd);
+    }
+    if (epfd >= 0)
+    {
+        close(epfd);
+    }
+}
+
+int RxEngine::watch(int socket)
+{
+    unwatch();
+
+    struct epoll_event ev;
+    memset(&ev, 0x0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.fd = socket;
+
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, socket, &ev) < 0)
+    {
+        if (errno != EEXIST || epoll_ctl(epfd, EPOLL_CTL_MOD, socket, &ev) < 0)
+        {
+            dbprintlf_err(LOG_MOD_RX, RED_FG "Failed to watch socket %d.", socket);
+            erprintlf(errno);
+            return -1;
+        }
+    }
+
+    watched = socket;
+    return 1;
+}
+
+void RxEngine::unwatch()
+{
+    if (watched >= 0)
+    {
+        // The socket may already have been closed, which removes it from the set; ignore the error.
+        epoll_ctl(epfd, EPOLL_CTL_DEL, watched, NULL);
+        watched = -1;
+    }
+    arm_timeout(0);
+}
+
+void RxEngine::arm_timeout(int seconds)
+{
+    struct itimerspec its;
+    memset(&its, 0x0, sizeof(its));
+    its.it_value.tv_sec = seconds;
+    timerfd_settime(timerfd, 0, &its, NULL);
+}
+
+void RxEngine::wake()
+{
+    uint64_t one = 1;
+    if (write(wakefd, &one, sizeof(one)) != sizeof(one))
+    {
+        // Counter saturated; a wakeup is already pending.
+    }
+}
+
+int RxEngine::wait(int timeout_ms)
+{
+    struct epoll_event evs[4];
+    int n = epoll_wait(epfd, evs, 4, timeout_ms);
+
+    if (n < 0)
+    {
+        return errno == EINTR ? 0 : RX_EV_ERROR;
+    }
+
+    int events = 0;
+    for (int i = 0; i < n; i++)
+    {
+        uint64_t count;
+        if (evs[i].data.fd == wakefd)
+        {
+            while (read(wakefd, &count, sizeof(count)) > 0)
+                ;
+            events |= RX_EV_WAKE;
+        }
+        else if (evs[i].data.fd == timerfd)
+        {
+            while (read(timerfd, &count, sizeof(count)) > 0)
+                ;
+            events |= RX_EV_TIMEOUT;
+        }
+        else
+        {
+            if (evs[i].events & EPOLLIN)
+            {
+                events |= RX_EV_READABLE;
+            }
+            if (evs[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            {
+                events |= RX_EV_HANGUP;
+            }
+        }
+    }
+
+    return events;
+}
+
+static inline unsigned int rx_dispatch_hash(int type, int mod, int cmd)
+{
+    unsigned int h = (unsigned int)type * 0x9E3779B1u;
+    h ^= (unsigned int)mod * 0x85EBCA77u;
+    h ^= (unsigned int)cmd * 0xC2B2AE3Du;
+    return (h ^ (h >> 15)) & (RX_DISPATCH_SLOTS - 1);
+}
+
+RxDispatcher::RxDispatcher() : unhandled(0)
+{
+    num_entries = 0;
+    for (int i = 0; i < RX_DISPATCH_SLOTS; i++)
+    {
+        table[i].used = false;
+        table[i].calls = 0;
+        table[i].ns_total = 0;
+        table[i].ns_max = 0;
+    }
+}
+
+rx_handler_entry_t *RxDispatcher::find(int type, int mod, int cmd)
+{
+    unsigned int idx = rx_dispatch_hash(type, mod, cmd);
+    for (int i = 0; i < RX_DISPATCH_SLOTS; i++)
+    {
+        rx_handler_entry_t *entry = &table[(idx + i) & (RX_DISPATCH_SLOTS - 1)];
+        if (!entry->used)
+        {
+            return NULL;
+        }
+        if (entry->type == type && entry->mod == mod && entry->cmd == cmd)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+int RxDispatcher::register_handler(const char *name, NetType net_type, int mod, int cmd, rx_handler_t fn, void *ctx)
+{
+    int type = (int)net_type;
+    rx_handler_entry_t *entry = find(type, mod, cmd);
+    if (entry != NULL)
+    {
+        entry->name = name;
+        entry->fn = fn;
+        entry->ctx = ctx;
+        return 1;
+    }
+
+    // Keep the load factor at or below one half so probes stay short.
+    if (num_entries >= RX_DISPATCH_SLOTS / 2)
+    {
+        dbprintlf_err(LOG_MOD_RX, RED_FG "Dispatch table full; cannot register %s.", name);
+        return -1;
+    }
+
+    unsigned int idx = rx_dispatch_hash(type, mod, cmd);
+    while (table[idx].used)
+    {
+        idx = (idx + 1) & (RX_DISPATCH_SLOTS - 1);
+    }
+
+    entry = &table[idx];
+    entry->type = type;
+    entry->mod = mod;
+    entry->cmd = cmd;
+    entry->name = name;
+    entry->fn = fn;
+    entry->ctx = ctx;
+    entry->used = true;
+    order[num_entries++] = idx;
+
+    return 1;
+}
+
+int RxDispatcher::dispatch(const gs_wire_hdr_t *hdr, rx_payload_view_t payload)
+{
+    int type = hdr->type;
+    int mod = RX_ANY;
+    int cmd = RX_ANY;
+
+    // DATA payloads are from-SPACE-HAUC cmd_output_t; key on its module and command.
+    if (type == (int)NetType::DATA && payload.size >= 2)
+    {
+        mod = payload.data[0];
+        cmd = payload.data[1];
+    }
+
+    rx_handler_entry_t *entry = find(type, mod, cmd);
+    if (entry == NULL && cmd != RX_ANY)
+    {
+        entry = find(type, mod, RX_ANY);
+    }
+    if (entry == NULL && mod != RX_ANY)
+    {
+        entry = find(type, RX_ANY, RX_ANY);
+    }
+    if (entry == NULL)
+    {
+        unhandled++;
+        return 0;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    entry->fn(entry->ctx, hdr, payload);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    uint64_t ns = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL + (end.tv_nsec - start.tv_nsec);
+
+    entry->calls++;
+    entry->ns_total += ns;
+    if (ns > entry->ns_max.load(std::memory_order_relaxed))
+    {
+        entry->ns_max = ns;
+    }
+
+    return 1;
+}
+
+int RxDispatcher::count()
+{
+    return num_entries;
+}
+
+const rx_handler_entry_t *RxDispatcher::entry(int idx)
+{
+    if (idx < 0 || idx >= num_entries)
+    {
+        return NULL;
+    }
+    return &table[order[idx]];
+}
+
+RxStream::RxStream(RxFramePool *pool) : reads(0), bytes(0), frames(0), wrapped(0), skipped(0), bad_frames(0), crc_mismatches(0), max_per_read(0)
+{
+    this->pool = pool;
+    held = NULL;
+    head = 0;
+    tail = 0;
+    skip_run = 0;
+    frames_this_read = 0;
+}
+
+RxStream::~RxStream()
+{
+    reset();
+}
+
+void RxStream::reset()
+{
+    if (held != NULL)
+    {
+        pool->release(held);
+        held = NULL;
+    }
+    head = 0;
+    tail = 0;
+    skip_run = 0;
+    frames_this_read = 0;
+}
+
+void RxStream::peek(size_t offset, void *dst, size_t len)
+{
+    size_t start = (head + offset) & (RX_STREAM_SIZE - 1);
+    size_t first = RX_STREAM_SIZE - start;
+    if (first >= len)
+    {
+        memcpy(dst, buf + start, len);
+    }
+    else
+    {
+        memcpy(dst, buf + start, first);
+        memcpy((unsigned char *)dst + first, buf, len - first);
+    }
+}
+
+uint16_t RxStream::crc(size_t offset, size_t len)
+{
+    size_t start = (head + offset) & (RX_STREAM_SIZE - 1);
+    size_t first = RX_STREAM_SIZE - start;
+    if (first >= len)
+    {
+        return gs_wire_crc16(buf + start, len);
+    }
+    return gs_wire_crc16_final(gs_wire_crc16_update(gs_wire_crc16_update(0xFFFF, buf + start, first), buf, len - first));
+}
+
+ssize_t RxStream::fill(int socket)
+{
+    size_t room = RX_STREAM_SIZE - (tail - head);
+    if (room == 0)
+    {
+        // Cannot happen: everything left after next(...) returns 0 is shorter than one frame.
+        return 0;
+    }
+
+    // Scatter into the free space, which wraps around the end of the ring at most once.
+    size_t start = tail & (RX_STREAM_SIZE - 1);
+    struct iovec iov[2];
+    iov[0].iov_base = buf + start;
+    iov[0].iov_len = RX_STREAM_SIZE - start < room ? RX_STREAM_SIZE - start : room;
+    iov[1].iov_base = buf;
+    iov[1].iov_len = room - iov[0].iov_len;
+
+    struct msghdr msg;
+    memset(&msg, 0x0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov[1].iov_len > 0 ? 2 : 1;
+
+    ssize_t retval = recvmsg(socket, &msg, MSG_DONTWAIT);
+
+    if (retval == 0)
+    {
+        return -404;
+    }
+    else if (retval < 0)
+    {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+
+    frames_this_read = 0;
+    tail += retval;
+    reads++;
+    bytes += retval;
+    return retval;
+}
+
+int RxStream::next(rx_frame_ref_t *ref)
+{
+    if (held != NULL)
+    {
+        pool->release(held);
+        held = NULL;
+    }
+
+    while (tail - head >= sizeof(gs_wire_hdr_t))
+    {
+        gs_wire_hdr_t hdr;
+        peek(0, &hdr, sizeof(gs_wire_hdr_t));
+
+        if (hdr.guid != GS_WIRE_GUID)
+        {
+            head++;
+            skip_run++;
+            skipped++;
+            continue;
+        }
+
+        if (gs_wire_check_hdr(&hdr) < 0)
+        {
+            lgprintlf_err(LOG_MOD_RX, RED_FG "Invalid frame header (payload size %d).", hdr.payload_size);
+            bad_frames++;
+            head++;
+            skip_run++;
+            skipped++;
+            continue;
+        }
+
+        size_t len = GS_WIRE_OVERHEAD + hdr.payload_size;
+        if (tail - head < len)
+        {
+            return 0;
+        }
+
+        gs_wire_ftr_t ftr;
+        peek(sizeof(gs_wire_hdr_t) + hdr.payload_size, &ftr, sizeof(gs_wire_ftr_t));
+
+        if (gs_wire_check_ftr(&hdr, &ftr) < 0)
+        {
+            lgprintlf_err(LOG_MOD_RX, RED_FG "Invalid frame footer (0x%04x).", ftr.termination);
+            bad_frames++;
+            head++;
+            skip_run++;
+            skipped++;
+            continue;
+        }
+
+        // Reported, not enforced, until the checksum is known to match NetFrame's.
+        uint16_t payload_crc = crc(sizeof(gs_wire_hdr_t), hdr.payload_size);
+        if (payload_crc != hdr.crc1 && crc_mismatches++ == 0)
+        {
+            lgprintlf_wrn(LOG_MOD_RX, YELLOW_FG "Payload CRC 0x%04x does not match the frame's 0x%04x; accepting it anyway.", payload_crc, hdr.crc1);
+        }
+
+        if (skip_run > 0)
+        {
+            lgprintlf_wrn(LOG_MOD_RX, YELLOW_FG "Skipped %d bytes to resynchronize on frame GUID.", skip_run);
+            skip_run = 0;
+        }
+
+        ref->hdr = hdr;
+        ref->payload.size = hdr.payload_size;
+
+        size_t start = (head + sizeof(gs_wire_hdr_t)) & (RX_STREAM_SIZE - 1);
+        if (start + hdr.payload_size <= RX_STREAM_SIZE)
+        {
+            ref->payload.data = buf + start;
+        }
+        else
+        { // Payload wraps around the end of the ring; make it contiguous.
+            held = pool->acquire();
+            held->hdr = hdr;
+            held->ftr = ftr;
+            peek(sizeof(gs_wire_hdr_t), held->payload, hdr.payload_size);
+            ref->payload.data = held->payload;
+            wrapped++;
+        }
+
+        head += len;
+        frames++;
+        if (++frames_this_read > max_per_read.load(std::memory_order_relaxed))
+        {
+            max_per_read = frames_this_read;
+        }
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,563 @@
+/**
+ * @file gs_sched.cpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Releases time-tagged commands at absolute UTC times, for pass automation.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include "gs.hpp"
+#include "gs_sched.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+uint64_t sched_utc_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief The window a command's module belongs to, for TX status and tracking.
+ *
+ * @return int TX_ORIGIN, or negative if the module cannot be scheduled.
+ */
+static int sched_origin(int mod)
+{
+    switch (mod)
+    {
+    case ACS_ID:
+        return TX_ORIGIN_ACS;
+    case EPS_ID:
+        return TX_ORIGIN_EPS;
+    case XBAND_ID:
+        return TX_ORIGIN_XBAND;
+    case SYS_VER_MAGIC:
+    case SYS_RESTART_PROG:
+    case SYS_REBOOT:
+    case SYS_CLEAN_SHBYTES:
+        return TX_ORIGIN_SYS_CTRL;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief The access level needed to send a command from its own window; restarts, reboots, and cleanups need the same level as they do in System Control.
+ *
+ * @return int Lowest access level allowed to schedule the module.
+ */
+static int sched_access(int mod)
+{
+    switch (mod)
+    {
+    case SYS_RESTART_PROG:
+    case SYS_REBOOT:
+    case SYS_CLEAN_SHBYTES:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+/**
+ * @brief Parses a whole token as an integer.
+ *
+ * @param str The token.
+ * @param base As for strtol(...).
+ * @param max Largest value accepted.
+ * @param value Set to the value on success.
+ * @return int 1 on success, negative if the token is not entirely a number from 0 to max.
+ */
+static int sched_parse_int(const char *str, int base, long max, int *value)
+{
+    char *end;
+    errno = 0;
+    long val = strtol(str, &end, base);
+    if (end == str || *end != '\0' || errno != 0 || val < 0 || val > max)
+    {
+        return -1;
+    }
+    *value = (int)val;
+    return 1;
+}
+
+/**
+ * @brief Parses a schedule time.
+ *
+ * @param str YYYY-MM-DDTHH:MM:SS[.fff][Z] (UTC), or +seconds.
+ * @param t Set to CLOCK_REALTIME nanoseconds, or to an offset if relative.
+ * @param relative Set if the time is relative to arming.
+ * @return int 1 on success, negative on failure.
+ */
+static int sched_parse_time(const char *str, uint64_t *t, bool *relative)
+{
+    if (str[0] == '+')
+    {
+        char *end;
+        double seconds = strtod(str + 1, &end);
+        if (end == str + 1 || *end != '\0' || !(seconds >= 0 && seconds < 1e9))
+        {
+            return -1;
+        }
+        *t = (uint64_t)(seconds * 1e9);
+        *relative = true;
+        return 1;
+    }
+
+    struct tm tm;
+    double seconds = 0;
+    int len = 0;
+    memset(&tm, 0x0, sizeof(tm));
+    if (sscanf(str, "%d-%d-%dT%d:%d:%lf%n", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &seconds, &len) != 6 || !(seconds >= 0 && seconds < 61))
+    {
+        return -1;
+    }
+    if (strcmp(str + len, "") != 0 && strcmp(str + len, "Z") != 0)
+    {
+        return -1;
+    }
+    if (tm.tm_mon < 1 || tm.tm_mon > 12 || tm.tm_mday < 1 || tm.tm_mday > 31 || tm.tm_hour < 0 || tm.tm_hour > 23 || tm.tm_min < 0 || tm.tm_min > 59)
+    {
+        return -1;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_sec = (int)seconds;
+
+    time_t whole = timegm(&tm);
+    if (whole < 0)
+    {
+        return -1;
+    }
+
+    *t = (uint64_t)whole * 1000000000ULL + (uint64_t)((seconds - tm.tm_sec) * 1e9);
+    *relative = false;
+    return 1;
+}
+
+CmdScheduler::CmdScheduler(TxEngine *tx) : released(0), skipped(0), tx(tx), num_entries(0), min_access(2), thread_started(false), running(false)
+{
+    timerfd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (timerfd < 0 || wakefd < 0)
+    {
+        dbprintlf_err(LOG_MOD_GEN, FATAL "Failed to create command scheduler timers.");
+        erprintlf(errno);
+    }
+}
+
+CmdScheduler::~CmdScheduler()
+{
+    cancel();
+    if (timerfd >= 0)
+    {
+        close(timerfd);
+    }
+    if (wakefd >= 0)
+    {
+        close(wakefd);
+    }
+}
+
+int CmdScheduler::load(const char *filename, char *error, int error_len)
+{
+    if (armed())
+    {
+        snprintf(error, error_len, "Cancel the armed schedule first.");
+        return -1;
+    }
+
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL)
+    {
+        snprintf(error, error_len, "Could not open %s (%s).", filename, strerror(errno));
+        return -1;
+    }
+
+    // Join a finished run before its entries are overwritten.
+    cancel();
+
+    char line[512];
+    int line_num = 0;
+    int count = 0;
+    int retval = 1;
+    int access = 2;
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        line_num++;
+
+        char *p = line;
+        while (isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        if (*p == '\0' || *p == '#')
+        {
+            continue;
+        }
+
+        if (count >= SCHED_MAX_ENTRIES)
+        {
+            snprintf(error, error_len, "Line %d: more than %d commands.", line_num, SCHED_MAX_ENTRIES);
+            retval = -1;
+            break;
+        }
+
+        sched_entry_t *entry = &entries[count];
+        char *save;
+        char *tok_time = strtok_r(p, " \t\r\n", &save);
+        char *tok_mod = strtok_r(NULL, " \t\r\n", &save);
+        char *tok_cmd = strtok_r(NULL, " \t\r\n", &save);
+
+        if (tok_mod == NULL || tok_cmd == NULL || sched_parse_time(tok_time, &entry->t_offset, &entry->relative) < 0)
+        {
+            snprintf(error, error_len, "Line %d: expected <time> <module> <command> [data bytes].", line_num);
+            retval = -1;
+            break;
+        }
+
+        if (sched_parse_int(tok_mod, 0, 0xff, &entry->mod) < 0 || sched_parse_int(tok_cmd, 0, 0xff, &entry->cmd) < 0)
+        {
+            snprintf(error, error_len, "Line %d: module and command must be numbers from 0 to 0xff.", line_num);
+            retval = -1;
+            break;
+        }
+        entry->origin = sched_origin(entry->mod);
+        if (entry->origin < 0)
+        {
+            snprintf(error, error_len, "Line %d: module 0x%x command 0x%x cannot be scheduled.", line_num, entry->mod, entry->cmd);
+            retval = -1;
+            break;
+        }
+        entry->cls = gs_cmd_tx_class(entry->mod);
+        if (sched_access(entry->mod) > access)
+        {
+            access = sched_access(entry->mod);
+        }
+
+        entry->data_size = 0;
+        memset(entry->data, 0x0, SCHED_DATA_LEN);
+        char *tok;
+        while ((tok = strtok_r(NULL, " \t\r\n", &save)) != NULL && tok[0] != '#')
+        {
+            if (entry->data_size >= SCHED_DATA_LEN)
+            {
+                snprintf(error, error_len, "Line %d: more than %d data bytes.", line_num, SCHED_DATA_LEN);
+                retval = -1;
+                break;
+            }
+            int byte;
+            if (sched_parse_int(tok, 16, 0xff, &byte) < 0)
+            {
+                snprintf(error, error_len, "Line %d: '%.8s' is not a data byte in hex.", line_num, tok);
+                retval = -1;
+                break;
+            }
+            entry->data[entry->data_size++] = (unsigned char)byte;
+        }
+        if (retval < 0)
+        {
+            break;
+        }
+
+        entry->t_sched = entry->relative ? 0 : entry->t_offset;
+        entry->line = line_num;
+        entry->state = SCHED_STATE_WAITING;
+        entry->t_release = 0;
+        entry->t_release_mono = 0;
+        entry->tx_tag = 0;
+        entry->seq = 0;
+        entry->result = -1;
+        entry->retval = 0;
+        entry->rtt = 0;
+        order[count] = count;
+        count++;
+    }
+
+    fclose(fp);
+
+    if (retval < 0)
+    {
+        num_entries = 0;
+        return retval;
+    }
+
+    num_entries = count;
+    min_access = access;
+    jitter.reset();
+    dbprintlf_inf(LOG_MOD_GEN, "Loaded %d scheduled commands from %s.", count, filename);
+    return count;
+}
+
+static void *gs_sched_thread(void *args)
+{
+    ((CmdScheduler *)args)->run();
+    return NULL;
+}
+
+int CmdScheduler::arm()
+{
+    if (armed() || num_entries == 0)
+    {
+        return -1;
+    }
+
+    // Join a finished run before starting another.
+    cancel();
+
+    uint64_t t_armed = sched_utc_ns();
+    for (int i = 0; i < num_entries; i++)
+    {
+        if (entries[i].relative)
+        {
+            entries[i].t_sched = t_armed + entries[i].t_offset;
+        }
+    }
+
+    std::stable_sort(order, order + num_entries, [this](int a, int b)
+                     { return entries[a].t_sched < entries[b].t_sched; });
+
+    uint64_t count;
+    while (read(wakefd, &count, sizeof(count)) > 0)
+        ;
+
+    running = true;
+    if (pthread_create(&thread, NULL, gs_sched_thread, this) != 0)
+    {
+        running = false;
+        dbprintlf_err(LOG_MOD_GEN, RED_FG "Failed to start command scheduler thread.");
+        return -1;
+    }
+    thread_started = true;
+
+    return 1;
+}
+
+void CmdScheduler::cancel()
+{
+    if (!thread_started)
+    {
+        return;
+    }
+
+    running = false;
+    uint64_t one = 1;
+    if (write(wakefd, &one, sizeof(one)) != sizeof(one))
+    {
+        // Counter saturated; a wakeup is already pending.
+    }
+    pthread_join(thread, NULL);
+    thread_started = false;
+}
+
+bool CmdScheduler::armed()
+{
+    return running;
+}
+
+int CmdScheduler::wait_until(uint64_t t_sched)
+{
+    struct itimerspec its;
+    memset(&its, 0x0, sizeof(its));
+    its.it_value.tv_sec = t_sched / 1000000000ULL;
+    its.it_value.tv_nsec = t_sched % 1000000000ULL;
+
+    while (running)
+    {
+        // Cancel-on-set makes a clock step end the wait with ECANCELED, so the deadline is re-evaluated against the new time.
+        if (timerfd_settime(timerfd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &its, NULL) < 0)
+        {
+            dbprintlf_err(LOG_MOD_GEN, RED_FG "Failed to arm command scheduler timer.");
+            erprintlf(errno);
+            return -1;
+        }
+
+        struct pollfd pfd[2];
+        pfd[0].fd = timerfd;
+        pfd[0].events = POLLIN;
+        pfd[1].fd = wakefd;
+        pfd[1].events = POLLIN;
+
+        if (poll(pfd, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+
+        if (pfd[1].revents & POLLIN)
+        {
+            break;
+        }
+
+        if (pfd[0].revents & POLLIN)
+        {
+            uint64_t expirations;
+            if (read(timerfd, &expirations, sizeof(expirations)) > 0)
+            {
+                return 1;
+            }
+            if (errno == ECANCELED)
+            {
+                dbprintlf_wrn(LOG_MOD_GEN, YELLOW_FG "System clock changed while waiting for a scheduled command.");
+            }
+        }
+    }
+
+    return 0;
+}
+
+void CmdScheduler::run()
+{
+    int i = 0;
+
+    for (; i < num_entries && running; i++)
+    {
+        sched_entry_t *entry = &entries[order[i]];
+
+        if (entry->state.load(std::memory_order_acquire) != SCHED_STATE_WAITING)
+        { // Already dealt with by an earlier run; reload the file to send it again.
+            continue;
+        }
+
+        if (wait_until(entry->t_sched) <= 0)
+        {
+            break;
+        }
+
+        uint64_t now = sched_utc_ns();
+        if (now > entry->t_sched + (uint64_t)SCHED_LATE_MAX * 1000000ULL)
+        {
+            lgprintlf_wrn(LOG_MOD_GEN, YELLOW_FG "Skipping scheduled command on line %d; %.3f s late.", entry->line, (now - entry->t_sched) / 1e9);
+            entry->state.store(SCHED_STATE_SKIPPED, std::memory_order_release);
+            skipped++;
+            continue;
+        }
+
+        // Built in its queue slot; only the mod, cmd, and data come from the file.
+        cmd_input_t *cmd = tx->reserve<cmd_input_t>(entry->origin, entry->cls);
+        if (cmd == NULL)
+        {
+            lgprintlf_err(LOG_MOD_GEN, RED_FG "TX queue full; scheduled command on line %d not sent.", entry->line);
+            entry->state.store(SCHED_STATE_FAILED, std::memory_order_release);
+            continue;
+        }
+        cmd->mod = entry->mod;
+        cmd->cmd = entry->cmd;
+        cmd->data_size = entry->data_size;
+        memcpy(cmd->data, entry->data, entry->data_size);
+
+        entry->t_release = sched_utc_ns();
+        entry->t_release_mono = lat_now_ns();
+        entry->tx_tag = tx->commit(cmd, NetType::DATA, NetVertex::ROOFUHF);
+        jitter.record(entry->t_release - entry->t_sched);
+        released++;
+        entry->state.store(SCHED_STATE_RELEASED, std::memory_order_release);
+
+        lgprintlf_dbg(LOG_MOD_GEN, "Released scheduled command on line %d, %.3f ms after its time.", entry->line, (entry->t_release - entry->t_sched) / 1e6);
+    }
+
+    for (; i < num_entries; i++)
+    {
+        sched_entry_t *entry = &entries[order[i]];
+        if (entry->state.load(std::memory_order_acquire) == SCHED_STATE_WAITING)
+        {
+            entry->state.store(SCHED_STATE_SKIPPED, std::memory_order_release);
+            skipped++;
+        }
+    }
+
+    running = false;
+}
+
+void CmdScheduler::collect(CmdTracker *tracker)
+{
+    for (int i = 0; i < num_entries; i++)
+    {
+        sched_entry_t *entry = &entries[i];
+
+        if (entry->state.load(std::memory_order_acquire) != SCHED_STATE_RELEASED)
+        {
+            continue;
+        }
+
+        if (entry->seq == 0 && entry->result == -1)
+        {
+            entry->seq = tracker->track(entry->mod, entry->cmd, entry->origin, entry->tx_tag, 0, entry->t_release_mono);
+            entry->result = entry->seq > 0 ? CMD_STATUS_PENDING : -2;
+            continue;
+        }
+
+        if (entry->result == CMD_STATUS_PENDING)
+        {
+            cmd_done_t done;
+            int status = tracker->lookup(entry->seq, &done);
+            if (status == CMD_STATUS_PENDING)
+            {
+                continue;
+            }
+            entry->result = status;
+            if (status == CMD_STATUS_ANSWERED)
+            {
+                entry->retval = done.retval;
+                entry->rtt = done.rtt;
+            }
+        }
+    }
+}
+
+int CmdScheduler::required_access()
+{
+    return min_access;
+}
+
+int CmdScheduler::count()
+{
+    return num_entries;
+}
+
+sched_entry_t *CmdScheduler::entry(int idx)
+{
+    if (idx < 0 || idx >= num_entries)
+    {
+        return NULL;
+    }
+    return &entries[order[idx]];
+}
+
+const char *CmdScheduler::state_name(int state)
+{
+    switch (state)
+    {
+    case SCHED_STATE_WAITING:
+        return "WAITING";
+    case SCHED_STATE_RELEASED:
+        return "RELEASED";
+    case SCHED_STATE_SKIPPED:
+        return "SKIPPED";
+    case SCHED_STATE_FAILED:
+        return "FAILED";
+    default:
+        return "UNKNOWN";
+    }
+}
@@ -0,0 +1,653 @@
+/**
+ * @file gs_tx.cpp
+ * @author Mit Bailey (mitbailey99@gmail.com)
+ * @brief Transmit-path infrastructure used by gs_tx_thread.
+ *
+ * @version See Git tags for version information.
+ * @date 2021.08.27
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "network.hpp"
+#include "gs_tx.hpp"
+#include "gs_latency.hpp"
+#include "gs_cmd.hpp"
+#include "meb_debug.hpp"
+
+TokenBucket::TokenBucket(uint32_t rate, uint32_t burst) : rate(rate), burst(burst), level(burst), tokens(burst), t_last(0) {}
+
+void TokenBucket::set(uint32_t rate, uint32_t burst)
+{
+    this->rate = rate;
+    this->burst = burst;
+}
+
+void TokenBucket::refill(uint64_t now)
+{
+    if (t_last == 0 || now < t_last)
+    {
+        t_last = now;
+    }
+
+    double cap = burst.load(std::memory_order_relaxed);
+    tokens += (now - t_last) * 1e-9 * rate.load(std::memory_order_relaxed);
+    if (tokens > cap)
+    {
+        tokens = cap;
+    }
+    t_last = now;
+    level.store((int64_t)tokens, std::memory_order_relaxed);
+}
+
+bool TokenBucket::available(int cost, uint64_t now, uint64_t *wait_ns)
+{
+    uint32_t r = rate.load(std::memory_order_relaxed);
+    if (r == 0)
+    {
+        return true;
+    }
+
+    refill(now);
+
+    // A frame larger than the burst is let through once the bucket is full, rather than never.
+    double need = cost;
+    double cap = burst.load(std::memory_order_relaxed);
+    if (need > cap)
+    {
+        need = cap;
+    }
+    if (tokens >= need)
+    {
+        return true;
+    }
+
+    *wait_ns = (uint64_t)((need - tokens) * 1e9 / r) + 1;
+    return false;
+}
+
+bool TokenBucket::take(int cost, uint64_t now)
+{
+    if (rate.load(std::memory_order_relaxed) == 0)
+    {
+        return false;
+    }
+
+    refill(now);
+    bool debt = tokens < cost;
+    tokens -= cost;
+    level.store((int64_t)tokens, std::memory_order_relaxed);
+    return debt;
+}
+
+void TokenBucket::refund(int cost)
+{
+    if (rate.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+    double cap = burst.load(std::memory_order_relaxed);
+    tokens += cost;
+    if (tokens > cap)
+    {
+        tokens = cap;
+    }
+    level.store((int64_t)tokens, std::memory_order_relaxed);
+}
+
+TxEngine::TxEngine() : active(true), submitted(0), rejected(0), sent(0), failed(0), bytes(0), writes(0), coalesced(0), max_batch(0), events_lost(0), throttled(0), uhf_debt(0), uhf(TX_UHF_RATE_DEFAULT, TX_UHF_BURST_DEFAULT), hold_ns(0), next_tag(1)
+{
+    memset(last, 0x0, sizeof(last));
+    for (int i = 0; i < TX_ORIGIN_NUM; i++)
+    {
+        last[i].origin = i;
+    }
+
+    for (int i = 0; i < TX_FLOW_NUM; i++)
+    {
+        weights[i] = 1;
+        deficit[i] = 0;
+        flow_sent[i] = 0;
+    }
+    for (int i = 0; i < TX_CLASS_NUM; i++)
+    {
+        rr_next[i] = 0;
+        rr_granted[i] = false;
+        class_sent[i] = 0;
+    }
+
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakefd < 0)
+    {
+        dbprintlf_err(LOG_MOD_TX, FATAL "Failed to create TX engine eventfd.");
+        erprintlf(errno);
+    }
+}
+
+TxEngine::~TxEngine()
+{
+    if (wakefd >= 0)
+    {
+        close(wakefd);
+    }
+}
+
+int TxEngine::submit(const void *payload, int size, NetType type, NetVertex destination, int origin, int cls)
+{
+    if (size < 0 || size > GS_WIRE_MAX_PAYLOAD_SIZE)
+    {
+        dbprintlf_err(LOG_MOD_TX, RED_FG "Payload of %d bytes cannot be sent.", size);
+        return -1;
+    }
+
+    tx_req_t *req = reserve_slot(origin, cls);
+    if (req == NULL)
+    {
+        return -1;
+    }
+
+    if (size > 0)
+    {
+        memcpy(req->payload, payload, size);
+    }
+
+    return commit_slot(req, size, type, destination);
+}
+
+tx_req_t *TxEngine::reserve_slot(int origin, int cls)
+{
+    if (origin < 0 || origin >= TX_ORIGIN_NUM)
+    {
+        dbprintlf_err(LOG_MOD_TX, RED_FG "Invalid origin %d.", origin);
+        return NULL;
+    }
+
+    int flow = cls == TX_CLASS_SAFETY ? TX_FLOW_SAFETY : origin;
+
+    tx_req_t *req = queue[flow].reserve();
+    if (req == NULL)
+    {
+        rejected++;
+        return NULL;
+    }
+
+    req->origin = origin;
+    req->cls = flow_class(flow);
+    return req;
+}
+
+int TxEngine::commit_slot(tx_req_t *req, int size, NetType type, NetVertex destination)
+{
+    // Keep tags positive so they can be returned as an int.
+    uint32_t tag = next_tag++ & 0x7fffffff;
+    if (tag == 0)
+    {
+        tag = next_tag++ & 0x7fffffff;
+    }
+
+    req->tag = tag;
+    req->type = (int)type;
+    req->destination = (int)destination;
+    req->size = size;
+    req->t_submit = lat_now_ns();
+
+    queue[req->cls == TX_CLASS_SAFETY ? TX_FLOW_SAFETY : req->origin].commit(req);
+    submitted++;
+    wake();
+
+    return (int)tag;
+}
+
+void TxEngine::wait(int timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = wakefd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, timeout_ms) > 0)
+    {
+        uint64_t count;
+        while (read(wakefd, &count, sizeof(count)) > 0)
+            ;
+    }
+}
+
+void TxEngine::stop()
+{
+    active = false;
+    wake();
+}
+
+void TxEngine::wake()
+{
+    uint64_t one = 1;
+    if (write(wakefd, &one, sizeof(one)) != sizeof(one))
+    {
+        // Counter saturated; a wakeup is already pending.
+    }
+}
+
+bool TxEngine::hold(const tx_req_t *req, uint64_t now, uint64_t *wait_ns)
+{
+    if (req->destination != (int)NetVertex::ROOFUHF || req->cls == TX_CLASS_SAFETY)
+    {
+        return false;
+    }
+    return !uhf.available(req->size > 0 ? req->size : 1, now, wait_ns);
+}
+
+int TxEngine::schedule(tx_req_t **batch, int *flows, int max)
+{
+    int taken[TX_FLOW_NUM] = {0}; // Frames already picked from each flow.
+    int count = 0;
+    uint64_t now = lat_now_ns();
+    uint64_t min_wait = 0; // Shortest wait of any held flow; zero if none are held.
+
+    if (max > TX_BATCH_MAX)
+    {
+        max = TX_BATCH_MAX;
+    }
+
+    // Strict priority: a class is only visited once every class above it has nothing left to send.
+    for (int cls = 0; cls < TX_CLASS_NUM && count < max; cls++)
+    {
+        bool backlogged = true;
+
+        // Deficit round robin: each turn, a flow earns its quantum and sends while its head frame fits in its credit.
+        while (backlogged && count < max)
+        {
+            backlogged = false;
+
+            for (int k = 0; k < TX_FLOW_NUM && count < max; k++)
+            {
+                int f = (rr_next[cls] + k) % TX_FLOW_NUM;
+                if (flow_class(f) != cls)
+                {
+                    continue;
+                }
+
+                tx_req_t *req = queue[f].peek(taken[f]);
+                if (req == NULL)
+                { // Idle flows do not bank credit.
+                    deficit[f] = 0;
+                    continue;
+                }
+
+                uint64_t wait = 0;
+                bool held = hold(req, now, &wait);
+                if (held)
+                { // Throttled flows do not earn credit either; the flow sits out until the link has room.
+                    min_wait = (min_wait == 0 || wait < min_wait) ? wait : min_wait;
+                    continue;
+                }
+
+                if (k > 0 || !rr_granted[cls])
+                {
+                    deficit[f] += weights[f].load(std::memory_order_relaxed) * TX_DRR_QUANTUM;
+                }
+
+                while (req != NULL && count < max && (int)GS_WIRE_OVERHEAD + req->size <= deficit[f])
+                {
+                    if ((held = hold(req, now, &wait)))
+                    {
+                        min_wait = (min_wait == 0 || wait < min_wait) ? wait : min_wait;
+                        break;
+                    }
+                    if (req->destination == (int)NetVertex::ROOFUHF && uhf.take(req->size > 0 ? req->size : 1, now) && req->cls == TX_CLASS_SAFETY)
+                    {
+                        uhf_debt++;
+                    }
+
+                    deficit[f] -= (int)GS_WIRE_OVERHEAD + req->size;
+                    batch[count] = req;
+                    flows[count++] = f;
+                    taken[f]++;
+                    req = queue[f].peek(taken[f]);
+                }
+
+                if (req == NULL)
+                {
+                    deficit[f] = 0;
+                }
+                else if (held)
+                {
+                    continue;
+                }
+                else if (count >= max)
+                { // Batch full mid-turn; resume this flow's turn next time without a new quantum.
+                    rr_next[cls] = f;
+                    rr_granted[cls] = true;
+                    hold_ns = min_wait;
+                    return count;
+                }
+                else
+                {
+                    backlogged = true;
+                }
+            }
+
+            rr_granted[cls] = false;
+        }
+    }
+
+    if (min_wait > 0 && hold_ns == 0)
+    { // Count the start of each throttled stretch, not every re-check while it lasts.
+        throttled++;
+    }
+    hold_ns = min_wait;
+
+    return count;
+}
+
+int TxEngine::throttle_wait_ms()
+{
+    if (hold_ns == 0)
+    {
+        return -1;
+    }
+    return (int)((hold_ns + 999999) / 1000000);
+}
+
+void TxEngine::pop(int flow)
+{
+    queue[flow].pop();
+}
+
+void TxEngine::complete(const tx_req_t *req, int status, int err)
+{
+    if (status == TX_STATUS_SENT)
+    {
+        sent++;
+        bytes += GS_WIRE_OVERHEAD + req->size;
+        flow_sent[req->cls == TX_CLASS_SAFETY ? TX_FLOW_SAFETY : req->origin]++;
+        class_sent[req->cls]++;
+    }
+    else
+    {
+        failed++;
+    }
+
+    // schedule(...) paid for it before the TX thread found no connection; a failed write may have reached the link, so only this is given back.
+    if (status == TX_STATUS_NOT_CONNECTED && req->destination == (int)NetVertex::ROOFUHF)
+    {
+        uhf.refund(req->size > 0 ? req->size : 1);
+    }
+
+    tx_event_t event;
+    event.tag = req->tag;
+    event.origin = req->origin;
+    event.type = req->type;
+    event.status = status;
+    event.err = err;
+    event.t_submit = req->t_submit;
+    event.t_done = lat_now_ns();
+
+    if (!events.push(event))
+    {
+        events_lost++;
+    }
+}
+
+int TxEngine::drain_events(CmdTracker *tracker)
+{
+    tx_event_t event;
+    int count = 0;
+
+    while (events.pop(&event))
+    {
+        if (event.origin >= 0 && event.origin < TX_ORIGIN_NUM)
+        {
+            last[event.origin] = event;
+        }
+        // Commands go out as DATA frames; anything else has no request to finish.
+        if (tracker != NULL && event.type == (int)NetType::DATA && (event.status == TX_STATUS_FAILED || event.status == TX_STATUS_NOT_CONNECTED))
+        {
+            tracker->unsent(event.tag);
+        }
+        count++;
+    }
+
+    return count;
+}
+
+const tx_event_t *TxEngine::last_event(int origin)
+{
+    if (origin < 0 || origin >= TX_ORIGIN_NUM)
+    {
+        return NULL;
+    }
+    return &last[origin];
+}
+
+size_t TxEngine::queued()
+{
+    size_t total = 0;
+    for (int i = 0; i < TX_FLOW_NUM; i++)
+    {
+        total += queue[i].size();
+    }
+    return total;
+}
+
+size_t TxEngine::queued(int flow)
+{
+    return queue[flow].size();
+}
+
+void TxEngine::set_weight(int flow, int weight)
+{
+    if (flow < 0 || flow >= TX_FLOW_NUM)
+    {
+        return;
+    }
+    if (weight < 1)
+    {
+        weight = 1;
+    }
+    else if (weight > TX_WEIGHT_MAX)
+    {
+        weight = TX_WEIGHT_MAX;
+    }
+    weights[flow] = weight;
+}
+
+int TxEngine::weight(int flow)
+{
+    return weights[flow].load();
+}
+
+int TxEngine::flow_class(int flow)
+{
+    switch (flow)
+    {
+    case TX_FLOW_SAFETY:
+        return TX_CLASS_SAFETY;
+    case TX_ORIGIN_CONNS:
+    case TX_ORIGIN_ACS_UPD:
+    case TX_ORIGIN_KEEPALIVE:
+        return TX_CLASS_POLL;
+    case TX_ORIGIN_SW_UPD:
+        return TX_CLASS_BULK;
+    default:
+        return TX_CLASS_COMMAND;
+    }
+}
+
+const char *TxEngine::flow_name(int flow)
+{
+    if (flow == TX_FLOW_SAFETY)
+    {
+        return "Safety";
+    }
+    return origin_name(flow);
+}
+
+const char *TxEngine::class_name(int cls)
+{
+    switch (cls)
+    {
+    case TX_CLASS_SAFETY:
+        return "SAFETY";
+    case TX_CLASS_COMMAND:
+        return "COMMAND";
+    case TX_CLASS_POLL:
+        return "POLL";
+    case TX_CLASS_BULK:
+        return "BULK";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+const char *TxEngine::origin_name(int origin)
+{
+    switch (origin)
+    {
+    case TX_ORIGIN_ACS:
+        return "ACS";
+    case TX_ORIGIN_EPS:
+        return "EPS";
+    case TX_ORIGIN_XBAND:
+        return "X-Band";
+    case TX_ORIGIN_SYS_CTRL:
+        return "System Control";
+    case TX_ORIGIN_SW_UPD:
+        return "Software Update";
+    case TX_ORIGIN_CONFIG:
+        return "Radio Configs";
+    case TX_ORIGIN_CONNS:
+        return "Connections";
+    case TX_ORIGIN_ACS_UPD:
+        return "ACS Update Poll";
+    case TX_ORIGIN_KEEPALIVE:
+        return "Server Keep-Alive";
+    default:
+        return "Unknown";
+    }
+}
+
+const char *TxEngine::status_name(int status)
+{
+    switch (status)
+    {
+    case TX_STATUS_NONE:
+        return "NONE";
+    case TX_STATUS_SENT:
+        return "SENT";
+    case TX_STATUS_FAILED:
+        return "FAILED";
+    case TX_STATUS_NOT_CONNECTED:
+        return "NOT CONNECTED";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+int gs_tx_write_batch(int socket, tx_req_t *const *reqs, int count, std::atomic<uint64_t> *writes)
+{
+    gs_wire_hdr_t hdrs[TX_BATCH_MAX];
+    gs_wire_ftr_t ftrs[TX_BATCH_MAX];
+    struct iovec iov[TX_BATCH_MAX * 3];
+    size_t frame_len[TX_BATCH_MAX];
+    int iovcnt = 0;
+
+    if (count > TX_BATCH_MAX)
+    {
+        count = TX_BATCH_MAX;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        const tx_req_t *req = reqs[i];
+        gs_wire_frame(&hdrs[i], &ftrs[i], (int)NetVertex::CLIENT, req->destination, req->type, req->payload, req->size);
+
+        iov[iovcnt].iov_base = &hdrs[i];
+        iov[iovcnt++].iov_len = sizeof(gs_wire_hdr_t);
+        if (req->size > 0)
+        {
+            iov[iovcnt].iov_base = (void *)req->payload;
+            iov[iovcnt++].iov_len = req->size;
+        }
+        iov[iovcnt].iov_base = &ftrs[i];
+        iov[iovcnt++].iov_len = sizeof(gs_wire_ftr_t);
+
+        frame_len[i] = GS_WIRE_OVERHEAD + req->size;
+    }
+
+    // Hold back partial segments until the whole batch is written; uncorking flushes.
+    int cork = count > 1 ? 1 : 0;
+    if (cork)
+    {
+        setsockopt(socket, IPPROTO_TCP, TCP_CORK, &cork, sizeof(cork));
+    }
+
+    int done = 0;          // Frames completely written.
+    size_t done_bytes = 0; // Bytes of the current frame already written.
+    struct iovec *cur = iov;
+    int remaining = iovcnt;
+
+    while (remaining > 0)
+    {
+        // sendmsg(...) is writev(...) plus MSG_NOSIGNAL, so a dead connection returns EPIPE instead of raising SIGPIPE.
+        struct msghdr msg;
+        memset(&msg, 0x0, sizeof(msg));
+        msg.msg_iov = cur;
+        msg.msg_iovlen = remaining;
+
+        ssize_t retval = sendmsg(socket, &msg, MSG_NOSIGNAL);
+        (*writes)++;
+
+        if (retval < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        // Credit whole frames, then skip the fully written iovecs and trim a partially written one.
+        done_bytes += retval;
+        while (done < count && done_bytes >= frame_len[done])
+        {
+            done_bytes -= frame_len[done];
+            done++;
+        }
+
+        size_t left = retval;
+        while (remaining > 0 && left >= cur->iov_len)
+        {
+            left -= cur->iov_len;
+            cur++;
+            remaining--;
+        }
+        if (remaining > 0)
+        {
+            cur->iov_base = (unsigned char *)cur->iov_base + left;
+            cur->iov_len -= left;
+        }
+    }
+
+    if (cork)
+    {
+        int err = errno;
+        cork = 0;
+        setsockopt(socket, IPPROTO_TCP, TCP_CORK, &cork, sizeof(cork));
+        errno = err;
+    }
+
+    return done;
+}